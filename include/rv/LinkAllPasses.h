@@ -23,6 +23,7 @@ void initializeLoopVectorizerPass(PassRegistry&);
 void initializeWFVPassPass(PassRegistry&);
 void initializeIRPolisherWrapperPass(PassRegistry&);
 void initializeLowerRVIntrinsicsPass(PassRegistry&);
+void initializePlatformInfoWrapperPassPass(PassRegistry&);
 } // namespace llvm
 
 namespace {
@@ -16,14 +16,25 @@
 #include "rv/resolver/resolver.h"
 #include "rv/intrinsics.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/DenseMap.h"
+#include <memory>
 
 namespace rv {
 
 class ListResolver;
 
 class PlatformInfo {
-  void registerDeclareSIMDFunction(llvm::Function & F);
-  void addIntrinsicMappings();
+  void registerDeclareSIMDFunction(llvm::Function & F) const;
+
+  // Functions are registered on their first resolver query (instead of scanning the whole module up-front).
+  // Register the builtin, RV intrinsic and "declare simd" mappings of \p F (once).
+  void registerFunction(llvm::Function & F) const;
+  // \p F is about to be deleted - forget all about it.
+  void forgetFunction(const llvm::Function & F) const;
+
+  class RegisteredFunctionVH;
+  mutable llvm::DenseMap<const llvm::Function*, std::unique_ptr<RegisteredFunctionVH>> registeredFuncs;
 
 public:
   PlatformInfo(llvm::Module &mod, llvm::TargetTransformInfo *TTI,
@@ -38,6 +49,11 @@ public:
 
   // insert a new function resolver into the resolver chain
   void addResolverService(std::unique_ptr<ResolverService>&& newResolver, bool givePrecedence);
+  // drop all resolver services (but keep the builtin list resolver and its mappings)
+  void resetResolverServices();
+
+  // drop all memoized getResolver answers (eg if the module's functions changed).
+  void invalidateResolverCache() const { resolverCache.clear(); }
 
   std::unique_ptr<FunctionResolver>
   getResolver(llvm::StringRef funcName,
@@ -82,6 +98,9 @@ private:
   llvm::TargetLibraryInfo *mTLI;
   std::vector<std::unique_ptr<ResolverService>> resolverServices;
   ListResolver * listResolver;
+
+  // memoized resolver queries (incl. negative answers)
+  mutable llvm::StringMap<std::shared_ptr<FunctionResolver>> resolverCache;
 };
 
 } // namespace rv
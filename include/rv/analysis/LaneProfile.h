@@ -0,0 +1,77 @@
+//===- rv/analysis/LaneProfile.h - lane occupancy profile --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Reader for the lane occupancy profiles written by code that was vectorized
+// with RV_PROFILE_LANES. Set RV_LANE_PROFILE_USE=<file> to feed a profile into
+// BOSCC, coherent-IF and width decisions.
+//
+
+#ifndef RV_ANALYSIS_LANEPROFILE_H
+#define RV_ANALYSIS_LANEPROFILE_H
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace llvm {
+  class BranchInst;
+}
+
+namespace rv {
+
+// accumulated counters of a single profiled block
+struct LaneStats {
+  uint64_t executions;
+  uint64_t activeLanes;
+  uint64_t noneActive; // executions without any active lane
+  uint64_t allActive; // executions with all lanes active
+  unsigned vectorWidth;
+
+  LaneStats()
+  : executions(0), activeLanes(0), noneActive(0), allActive(0), vectorWidth(0)
+  {}
+
+  // fraction of executions in which the block could have been skipped
+  double getNoneRatio() const { return executions ? noneActive / (double) executions : 0.0; }
+  // fraction of executions with a full mask
+  double getAllRatio() const { return executions ? allActive / (double) executions : 0.0; }
+  // fraction of executions with a partially active mask
+  double getMixedRatio() const { return executions ? 1.0 - getNoneRatio() - getAllRatio() : 0.0; }
+  // average fraction of active lanes
+  double getOccupancy() const {
+    return (executions && vectorWidth) ? activeLanes / (double) (executions * vectorWidth) : 1.0;
+  }
+};
+
+class LaneProfile {
+  // "<function>\t<block>" -> stats
+  llvm::StringMap<LaneStats> sites;
+
+public:
+  // parse the profile in @path (accumulates all lines of a site)
+  bool readFromFile(llvm::StringRef path);
+
+  // stats for @blockName in the vector function @funcName (nullptr if the block was not profiled)
+  const LaneStats * lookup(llvm::StringRef funcName, llvm::StringRef blockName) const;
+
+  // pick the successor of @branch in @funcName that a branch transform (BOSCC, CIF) should apply to.
+  // @getScore rates the stats of a successor (nullptr if it was not profiled). Legal successors with a score >= 0
+  // qualify, the higher score wins. Sets @oDecision to 0 (none), -1 (onTrue) or 1 (onFalse).
+  // Returns false if no successor of @branch was profiled.
+  bool pickSuccessor(const llvm::BranchInst & branch, llvm::StringRef funcName, bool onTrueLegal, bool onFalseLegal,
+                     std::function<double(const LaneStats *)> getScore, int & oDecision) const;
+
+  // the profile configured with RV_LANE_PROFILE_USE (nullptr if there is none)
+  static const LaneProfile * getProfile();
+};
+
+} // namespace rv
+
+#endif // RV_ANALYSIS_LANEPROFILE_H
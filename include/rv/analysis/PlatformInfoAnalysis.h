@@ -0,0 +1,47 @@
+//===- rv/analysis/PlatformInfoAnalysis.h - module-level PlatformInfo --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef RV_ANALYSIS_PLATFORMINFOANALYSIS_H
+#define RV_ANALYSIS_PLATFORMINFOANALYSIS_H
+
+#include "llvm/Pass.h"
+#include "rv/PlatformInfo.h"
+#include "rv/config.h"
+
+#include <memory>
+#include <string>
+
+namespace rv {
+
+// Caches one PlatformInfo (and its resolver chain) per module.
+// Functions register with the PlatformInfo on their first resolver query and
+// are forgotten when they are deleted. So, the per-function cost of using it
+// does not grow with the size of the module.
+class PlatformInfoWrapperPass : public llvm::ImmutablePass {
+  std::unique_ptr<PlatformInfo> platInfo;
+  std::string resolverConfigKey; // configuration the resolver chain was built for
+
+public:
+  static char ID;
+  PlatformInfoWrapperPass();
+
+  // return the PlatformInfo of \p F's module configured for \p F.
+  // The resolver chain is only rebuilt if \p config differs from the last request.
+  PlatformInfo & getPlatformInfo(llvm::Function & F, llvm::TargetTransformInfo & TTI, llvm::TargetLibraryInfo & TLI, const Config & config);
+
+  bool doInitialization(llvm::Module & M) override;
+  bool doFinalization(llvm::Module & M) override;
+};
+
+} // namespace rv
+
+namespace llvm {
+void initializePlatformInfoWrapperPassPass(PassRegistry &);
+} // namespace llvm
+
+#endif // RV_ANALYSIS_PLATFORMINFOANALYSIS_H
@@ -91,6 +91,9 @@ public:
 
   void analyze();
   void updateAnalysis(InstVec &updateList);
+  // re-compute the shapes of @seedList (e.g. instructions created by a transformation) and all instructions depending on them.
+  // Unlike updateAnalysis, shapes may also become more precise. Falls back to a full analysis if a divergent branch would be affected.
+  void reanalyze(InstVec &seedList);
 
   void addInitial(const llvm::Instruction *inst, VectorShape shape);
 
@@ -10,6 +10,7 @@
 #define RV_ANALYSIS_COSTMODEL_H
 
 #include <cstddef>
+#include <llvm/ADT/StringRef.h>
 
 namespace llvm {
   class Instruction;
@@ -17,6 +18,7 @@ namespace llvm {
   class BasicBlock;
   class TargetTransformInfo;
   class Function;
+  class CallInst;
 }
 
 namespace rv {
@@ -35,6 +37,17 @@ class CostModel {
 
   bool needsReplication(const llvm::Instruction & inst) const;
 
+  // TTI throughput of @inst as a scalar instruction
+  double getScalarCost(const llvm::Instruction & inst) const;
+
+  // throughput of @inst in vector code (with the shapes and width in @vecInfo)
+  double getMemoryCost(const VectorizationInfo & vecInfo, const llvm::Instruction & inst, bool isPredicated) const;
+  double getCallCost(const VectorizationInfo & vecInfo, const llvm::CallInst & call, bool isPredicated) const;
+  double getVectorCost(const VectorizationInfo & vecInfo, const llvm::Instruction & inst, bool isPredicated) const;
+
+  // cost of emulating @inst with one scalar instance per lane
+  double getReplicationCost(const llvm::Instruction & inst, size_t width, bool isPredicated) const;
+
 public:
   CostModel(PlatformInfo & _platInfo, Config & _config);
 
@@ -53,6 +66,18 @@ public:
   // pick a vector width for a single block/the region
   size_t pickWidthForBlock(const llvm::BasicBlock & block, size_t maxWidth) const;
   size_t pickWidthForRegion(const Region & region, size_t maxWidth) const;
+
+  // pick the number of vector iterations to interleave for a loop with @numReductionChains loop-carried reduction chains
+  size_t pickInterleaveCount(const Region & region, size_t vectorWidth, size_t numReductionChains) const;
+
+  // estimated throughput cost of one iteration of the scalar region
+  // if @profileFuncName was lane profiled, predicated blocks are weighted by their lane occupancy
+  double estimateScalarCost(const Region & region, llvm::StringRef profileFuncName = "") const;
+
+  // estimated throughput cost of one vector iteration of the region in @vecInfo (after the VA)
+  // this covers vecInfo.getVectorWidth() scalar iterations
+  // if @allPredicated, the cost is estimated for a region entered with a partial mask
+  double estimateVectorCost(const VectorizationInfo & vecInfo, bool allPredicated = false) const;
 };
 
 }
@@ -15,6 +15,8 @@
 #include <llvm/Analysis/LoopInfo.h>
 #include <llvm/Support/raw_ostream.h>
 
+#include "rv/analysis/reductions.h"
+
 namespace rv {
   using iter_t = int64_t;
 
@@ -44,6 +46,14 @@ namespace rv {
     }
   };
 
+  // how the iterations that do not fill a whole vector are executed
+  enum class RemainderMode {
+    Scalar = 0, // scalar remainder loop
+    MaskedEpilogue = 1, // one more vector iteration under an iteration-bound mask
+    Predicated = 2 // a single predicated vector loop (no remainder)
+  };
+  const char* to_string(RemainderMode mode);
+
   struct
   LoopMD {
     // whether this loop was already vectorized
@@ -58,6 +68,15 @@ namespace rv {
     // minimum dependence distance between two loop iterations
     Optional<iter_t> minDepDist;
 
+    // requested treatment of the remainder iterations
+    Optional<RemainderMode> remainderMode;
+
+    // requested finalization of the loop's reductions
+    Optional<ReductionMode> reductionMode;
+
+    // number of vector iterations to interleave
+    Optional<iter_t> interleaveCount;
+
     llvm::raw_ostream& print(llvm::raw_ostream & out) const;
     void dump() const;
   };
@@ -58,16 +58,38 @@ public:
   RedKind kind;
   // the instructions that make up this reduction pattern
   InstSet elements;
+  // the running value of the reduction is used inside @levelLoop (inclusive or exclusive prefix scan)
+  // a scan is a single reductor (and its header phi) that executes in every iteration
+  bool isScan;
+  // paired reduction: a payload (@kind == Bot) is selected in the iterations that update the min/max reduction @keyRed (arg-min/arg-max)
+  // or, without a key, in the last iteration in which its select condition holds (conditional last value)
+  bool isPayload;
+  Reduction * keyRed;
+  // ties of @keyRed pick the payload of the first iteration (the key only updates on a strict improvement), otw the last
+  bool pickFirst;
+  // stream compaction index (if (p) out[k++] = v): an Add chain that increments by one under a condition
+  // the running value only addresses stores in the incrementing block
+  bool isCompact;
 
   Reduction(InstSet _elements)
   : levelLoop(nullptr)
   , kind(RedKind::Bot)
   , elements(_elements)
+  , isScan(false)
+  , isPayload(false)
+  , keyRed(nullptr)
+  , pickFirst(false)
+  , isCompact(false)
   {}
 
   Reduction(llvm::Loop & _levelLoop, RedKind _kind)
   : levelLoop(&_levelLoop)
   , kind(_kind)
+  , isScan(false)
+  , isPayload(false)
+  , keyRed(nullptr)
+  , pickFirst(false)
+  , isCompact(false)
   {}
 
 
@@ -75,6 +97,11 @@ public:
   : levelLoop(&_levelLoop)
   , kind(RedKind::Bot)
   , elements()
+  , isScan(false)
+  , isPayload(false)
+  , keyRed(nullptr)
+  , pickFirst(false)
+  , isCompact(false)
   {
     elements.insert(&_seedElem);
   }
@@ -88,7 +115,7 @@ public:
   bool canPrivatize() const { false; } // TODO implement
 #endif
 
-  VectorShape getShape(int vectorWidth) const { return kind == RedKind::Bot ? VectorShape::undef() : VectorShape::varying(); } // infer a suitable vector shape
+  VectorShape getShape(int vectorWidth) const { return (kind == RedKind::Bot && !isPayload) ? VectorShape::undef() : VectorShape::varying(); } // infer a suitable vector shape
 
   // shorthands
   bool contains(llvm::Instruction & elem) const { return elements.find(&elem) != elements.end(); }
@@ -125,6 +152,12 @@ class ReductionAnalysis {
   // returns true if the value of this instruction can be recomputed even if loop iterations execute in parallel/or SIMD fashing
   bool canReconstructInductively(llvm::Instruction & inst) const { return getStrideInfo(inst); }
 
+  // whether @val (transitively) depends on a header phi of @loop that is not a stride pattern
+  bool dependsOnRecurrence(llvm::Value & val, llvm::Loop & loop) const;
+
+  // match the recurrence @red of header phi @phi as the payload of a paired reduction (arg-min/arg-max or conditional last value)
+  bool matchPayload(Reduction & red, llvm::PHINode & phi, llvm::Loop & loop);
+
   // reset internal state
   void clear();
 public:
@@ -32,13 +32,23 @@ enum class RedKind : int64_t {
   UMax = 6,
   SMin = 7,
   UMin = 8,
+  Xor = 9,
 
-  Enum_End = 9
+  Enum_End = 10
 };
 
 // join operator
 RedKind JoinKinds(RedKind A, RedKind B);
 
+// how the lanes of a vector reduction are combined into the scalar result
+enum class ReductionMode : int {
+  Auto = 0, // vector-reduce intrinsics (reassociating if the reduction has 'reassoc' fast-math flags), shuffle tree fallback
+  Tree = 1, // log2(W) shuffle tree
+  Intrinsic = 2, // reassociating vector-reduce intrinsics
+  Ordered = 3 // strictly ordered in-lane accumulation (bit-exact to the scalar loop)
+};
+const char* to_string(ReductionMode mode);
+
 llvm::StringRef to_string(RedKind red);
 bool from_string(llvm::StringRef redKindText, RedKind & oRedKind);
 
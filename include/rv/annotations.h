@@ -14,6 +14,7 @@
 namespace llvm {
   class Function;
   class PHINode;
+  class Instruction;
 }
 
 namespace rv {
@@ -22,6 +23,14 @@ namespace rv {
 
   void SetReductionHint(llvm::PHINode & loopHeaderPhi, RedKind redKind);
   RedKind ReadReductionHint(const llvm::PHINode & loopHeaderPhi);
+
+  // requested finalization of the reduction rooted in @loopHeaderPhi
+  void SetReductionModeHint(llvm::PHINode & loopHeaderPhi, ReductionMode mode);
+  ReductionMode ReadReductionModeHint(const llvm::PHINode & loopHeaderPhi); // Auto if unknown
+
+  // alignment (in bytes) of the first lane address of a contiguous vector access (e.g. after alignment peeling)
+  void SetAlignmentHint(llvm::Instruction & memInst, unsigned alignment);
+  unsigned ReadAlignmentHint(const llvm::Instruction & memInst); // 1 if unknown
 }
 
 #endif
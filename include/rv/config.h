@@ -43,6 +43,7 @@ struct Config {
   bool enableMaskedMove;
   bool enableInterleaved;
   bool useSafeDivisors; // blend-in safe divisors to eliminate spurious arithmetic exceptions
+  bool enableLaneProfiling; // count active lanes of predicated blocks at runtime
 
 // optimization flags
   bool enableSplitAllocas;
@@ -52,10 +53,16 @@ struct Config {
   bool enableHeuristicBOSCC;
   bool enableCoherentIF;
   bool enableOptimizedBlends;
+  bool enableMaskedRemainder; // let the cost model pick masked/predicated loop remainders
+  bool enableLoopVersioning; // runtime overlap checks and alignment peeling for non-parallel loops
+  bool enableLoopInterleaving; // let the cost model interleave vector loop iterations (independent accumulators)
 
 // greedy inter-procedural vectorizatoin
   bool enableGreedyIPV;
 
+// diagnostics
+  bool enablePhaseTimers; // -time-passes timers for the vectorizer phases (process-wide, off on WFV worker threads)
+
   // maximum ULP error bound for math functions
   // unit for maxULPErrorBound is tenth of ULP (a value of 10 implies that an ULP error of <= 1.0 is acceptable)
   int maxULPErrorBound;
@@ -60,6 +60,14 @@ public:
     void analyze(VectorizationInfo& vecInfo,
                  llvm::FunctionAnalysisManager &FAM);
 
+    //
+    // Update an existing analysis result in \p vecInfo (eg imported from a variant of the same function)
+    // by re-visiting the instructions in \p updateList and everything that depends on them.
+    //
+    void updateAnalysis(VectorizationInfo& vecInfo,
+                        llvm::FunctionAnalysisManager &FAM,
+                        const std::vector<const llvm::Instruction*> & updateList);
+
 
     //
     // Linearize divergent regions of the scalar function to preserve semantics for the
@@ -28,6 +28,7 @@ namespace llvm {
   class PostDominatorTree;
   class MemoryDependenceResults;
   class BranchProbabilityInfo;
+  class OptimizationRemarkEmitter;
 }
 
 
@@ -47,6 +48,7 @@ public:
   , SE(nullptr)
   , MDR(nullptr)
   , PB(nullptr)
+  , ORE(nullptr)
   , reda()
   , vectorizer()
   {}
@@ -70,6 +72,7 @@ private:
   llvm::ScalarEvolution * SE;
   llvm::MemoryDependenceResults * MDR;
   llvm::BranchProbabilityInfo * PB;
+  llvm::OptimizationRemarkEmitter * ORE;
   std::unique_ptr<ReductionAnalysis> reda;
   std::unique_ptr<VectorizerInterface> vectorizer;
 
@@ -88,6 +91,24 @@ private:
   // returns 1 for loop w/o known alignment
   int getTripAlignment(llvm::Loop & L);
 
+  // run the VA on the (untransformed) loop @L with the width of @trialInfo.
+  // Returns false if a header phi is not vectorizable.
+  bool analyzeTrialLoop(llvm::Loop &L, VectorizationInfo & trialInfo);
+
+  // pick the width with the best estimated throughput (up to @maxWidth) by
+  // running the VA on @L for every candidate width. Returns 1 if scalar code is faster.
+  size_t pickWidthByCost(llvm::Loop &L, size_t maxWidth);
+
+  // pick the cheaper execution of the remainder iterations (scalar loop or masked vector iteration)
+  // @tripCount is -1 if unknown
+  RemainderMode pickRemainderMode(llvm::Loop &L, int VectorWidth, int tripCount);
+
+  // vectorize @PreparedLoop (created for the annotated loop @L)
+  // its reductions are finalized according to @redMode
+  // whether the header phis of @CheckLoop are supported recurrences (emits missed remarks for @L otherwise)
+  bool checkHeaderPhis(llvm::Loop &L, llvm::Loop &CheckLoop, ReductionMode redMode);
+  bool vectorizePreparedLoop(llvm::Loop &L, llvm::Loop &PreparedLoop, int VectorWidth, ValueSet & uniformOverrides, ReductionMode redMode);
+
   bool vectorizeLoop(llvm::Loop &L);
   bool vectorizeLoopOrSubLoops(llvm::Loop &L);
 };
@@ -12,6 +12,7 @@
 
 #include "llvm/Pass.h"
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseSet.h"
 
 #include "llvm/Transforms/Utils/ValueMapper.h"
@@ -22,6 +23,8 @@
 #include "rv/passes.h"
 
 #include <limits>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace llvm {
@@ -32,6 +35,8 @@ namespace llvm {
   class PostDominatorTree;
   class MemoryDependenceResults;
   class BranchProbabilityInfo;
+  class TargetTransformInfo;
+  class TargetLibraryInfo;
 }
 
 
@@ -39,9 +44,13 @@ namespace rv {
 
 struct VectorMapping;
 class VectorizerInterface;
+class PlatformInfo;
+struct Config;
+struct WFVSharedAnalysis;
 
 class WFVPass : public llvm::ModulePass {
   bool enableDiagOutput; // WFV_DIAG
+  unsigned numThreads; // RV_WFV_THREADS
 
   std::vector<VectorMapping> wfvJobs;
 
@@ -52,12 +61,42 @@ class WFVPass : public llvm::ModulePass {
   bool isSaneMapping(VectorMapping & wfvJob) const;
 
   /// generate the Vector Function ABI variant encoded in \p wfvJob.
-  void vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfvJob);
+  /// If \p sharedVA is set, start from its prepared function and analysis.
+  void vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfvJob,
+                         WFVSharedAnalysis * sharedVA) const;
+
+  /// prepare and analyze a clone of the scalar function of \p wfvJob for reuse
+  /// by all variants of the function.
+  std::unique_ptr<WFVSharedAnalysis>
+  createSharedAnalysis(VectorizerInterface & vectorizer, const VectorMapping & wfvJob) const;
+
+  /// vectorize all \p jobs (in order), analyzing every scalar function only once.
+  void vectorizeJobs(VectorizerInterface & vectorizer, std::vector<VectorMapping> & jobs) const;
+
+  /// partition wfvJobs into clusters that have to be vectorized by the same
+  /// worker (variants of the same scalar function, functions calling each other).
+  std::vector<std::vector<unsigned>> clusterJobs() const;
+
+  /// vectorize all jobs in \p cluster on \p workMod, a private copy of the
+  /// module (in its own context). The resulting vector functions are returned
+  /// as bitcode in \p resultBC. The diagnostic output of the worker is
+  /// buffered in \p reportText. \p TTI and \p TLI are private to the worker
+  /// and were created for a function of \p workMod.
+  void vectorizeCluster(llvm::Module & workMod, llvm::ArrayRef<unsigned> cluster,
+                        llvm::TargetTransformInfo * TTI, llvm::TargetLibraryInfo * TLI,
+                        const Config & rvConfig, std::string & resultBC,
+                        std::string & reportText) const;
+
+  /// vectorize independent job clusters in parallel (RV_WFV_THREADS > 1).
+  /// The workers use the target info of \p protoFunc.
+  void runParallel(llvm::Module & M, llvm::Function & protoFunc, const Config & rvConfig);
 public:
   static char ID;
 
   WFVPass()
   : ModulePass(ID)
+  , enableDiagOutput(false)
+  , numThreads(1)
   {}
 
   void getAnalysisUsage(llvm::AnalysisUsage &AU) const override;
@@ -39,9 +39,11 @@ class BOSCCTransform {
   llvm::PostDominatorTree & postDomTree;
   llvm::LoopInfo & loopInfo;
   llvm::BranchProbabilityInfo * pbInfo;
+  bool useHeuristics;
 
 public:
-  BOSCCTransform(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo, MaskExpander & _maskEx, llvm::FunctionAnalysisManager &FAM);
+  // if !@_useHeuristics only branches with lane profile data (RV_LANE_PROFILE_USE) are considered
+  BOSCCTransform(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo, MaskExpander & _maskEx, llvm::FunctionAnalysisManager &FAM, bool _useHeuristics = true);
 
   bool run();
 };
@@ -29,6 +29,9 @@ namespace rv {
 // so the IR polisher tries to replace these by vectors of
 // i32/i64 instead. Note that this requires SSE41/AVX2 for
 // the integer vector instructions.
+// On AVX-512, <n x i1> lives in the mask registers. There,
+// the polisher keeps the i1 vectors and only rewrites mask
+// patterns the backend can select as k-register operations.
 class IRPolisher {
   llvm::Function &F;
   llvm::Type* boolVector;
@@ -76,6 +79,12 @@ class IRPolisher {
   llvm::Value *getMaskForValueOrInst(llvm::IRBuilder<>&, llvm::Value*, unsigned);
   llvm::Value *getConditionFromMask(llvm::IRBuilder<>&, llvm::Value*);
 
+  // AVX-512 predicate mode
+  bool polishPredicates();
+  llvm::Value *lowerMaskReduction(llvm::CallInst*);
+  llvm::Value *lowerMoveMask(llvm::CallInst*);
+  llvm::Value *foldMaskedArithmetic(llvm::Instruction*);
+
 public:
   IRPolisher(llvm::Function &f, Config _config) : F(f), config(_config) {}
 
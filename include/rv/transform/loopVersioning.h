@@ -0,0 +1,79 @@
+//===- rv/transform/loopVersioning.h - runtime checks and alignment peeling --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+
+#ifndef RV_TRANSFORM_LOOPVERSIONING_H
+#define RV_TRANSFORM_LOOPVERSIONING_H
+
+#include "llvm/IR/Function.h"
+
+#include <vector>
+#include <utility>
+
+namespace llvm {
+  class LoopInfo;
+  class Loop;
+  class DominatorTree;
+  class PostDominatorTree;
+  class ScalarEvolution;
+  class BranchProbabilityInfo;
+  class SCEV;
+  class BasicBlock;
+}
+
+namespace rv {
+
+// Multi-versioning of annotated loops before they are prepared by the RemainderTransform:
+// - pointer overlap checks in the vector loop guard (falls back to the scalar loop if they fail)
+// - a scalar peel loop that aligns the main unit-stride access of the vector loop
+class LoopVersioningTransform {
+  llvm::Function & F;
+  llvm::DominatorTree & DT;
+  llvm::PostDominatorTree & PDT;
+  llvm::LoopInfo & LI;
+  llvm::ScalarEvolution & SE;
+  llvm::BranchProbabilityInfo * PB;
+
+  // accessed address range [lo, hi) of a memory instruction over all loop iterations
+  struct AccessRange {
+    const llvm::SCEV * lo;
+    const llvm::SCEV * hi;
+  };
+  std::vector<AccessRange> accessRanges;
+
+  // pairs of accessRanges that must not overlap
+  std::vector<std::pair<size_t, size_t>> overlapChecks;
+
+public:
+  LoopVersioningTransform(llvm::Function & _F, llvm::DominatorTree & _DT, llvm::PostDominatorTree & _PDT, llvm::LoopInfo & _LI, llvm::ScalarEvolution & _SE, llvm::BranchProbabilityInfo * _PB = nullptr)
+  : F(_F)
+  , DT(_DT)
+  , PDT(_PDT)
+  , LI(_LI)
+  , SE(_SE)
+  , PB(_PB)
+  {}
+
+  // collect the overlap checks for vectorizing the (not annotated parallel) loop @L with @vectorWidth.
+  // returns false if the memory accesses of @L can not be checked at runtime.
+  bool analyzeOverlapChecks(llvm::Loop & L, int vectorWidth);
+  bool needsOverlapChecks() const { return !overlapChecks.empty(); }
+
+  // emit the collected overlap checks in the vector loop guard @vecGuardBlock
+  // the vector loop (@vecHeader) is only entered if no checked accesses overlap
+  void insertOverlapChecks(llvm::BasicBlock & vecGuardBlock, llvm::BasicBlock & vecHeader);
+
+  // peel scalar iterations off @L until its main unit-stride access is aligned to a full vector of @vectorWidth elements.
+  // the access is annotated with an alignment hint for the vector code generator.
+  // returns true if a peel loop was inserted (the trip count of @L is no longer known afterwards).
+  bool peelForAlignment(llvm::Loop & L, int vectorWidth);
+};
+
+}
+
+#endif // RV_TRANSFORM_LOOPVERSIONING_H
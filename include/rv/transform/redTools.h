@@ -23,7 +23,14 @@ struct Config;
 llvm::Instruction& CreateReductInst(llvm::IRBuilder<> & builder, RedKind redKind, llvm::Value & firstArg, llvm::Value & secondArg);
 
 // reduce the vector @vectorVal to a scalar value (using redKind)
-llvm::Value & CreateVectorReduce(Config & config, llvm::IRBuilder<> & builder, RedKind redKind, llvm::Value & vectorVal, llvm::Value * initVal);
+// @mode selects the lane combination order (see ReductionMode)
+llvm::Value & CreateVectorReduce(Config & config, llvm::IRBuilder<> & builder, RedKind redKind, llvm::Value & vectorVal, llvm::Value * initVal, ReductionMode mode = ReductionMode::Auto);
+
+// inclusive prefix scan of the lanes of @vecVal (using redKind), lane i holds vecVal[0] ~ .. ~ vecVal[i]
+llvm::Value & CreateVectorScan(llvm::IRBuilder<> & builder, RedKind redKind, llvm::Value & vecVal);
+
+// pick the lane of @payloadVec with the smallest (@pickFirst) or largest iteration stamp in @stampVec among the lanes in @candMask (all lanes if nullptr)
+llvm::Value & CreatePayloadReduce(Config & config, llvm::IRBuilder<> & builder, llvm::Value & payloadVec, llvm::Value & stampVec, llvm::Value * candMask, bool pickFirst);
 
 // if laneOffset is >= 0 create an extract from that offset, if laneOffset < 0 add the vector width first
 // will return @vecVal if it is not a vector (uniform value)
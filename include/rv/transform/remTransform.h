@@ -62,6 +62,12 @@ public:
   // create a vectorizable loop or return nullptr if remTrans can not currently do it
   llvm::Loop*
   createVectorizableLoop(llvm::Loop & L, ValueSet & uniOverrides, int vectorWidth, int tripAlign);
+
+  // predicate the loop \p L in place such that it can be vectorized without a remainder loop.
+  // inactive lanes (iterations past the loop exit) are masked by an iteration-bound guard.
+  // returns nullptr (leaving \p L unchanged) if the loop can not be predicated.
+  llvm::Loop*
+  createPredicatedLoop(llvm::Loop & L, ValueSet & uniOverrides, int vectorWidth);
 };
 
 }
@@ -13,11 +13,14 @@
 #include <llvm/IR/Value.h>
 #include <llvm/Transforms/Utils/ValueMapper.h>
 
+#include <vector>
+
 #include "rv/PlatformInfo.h"
 #include "rv/shape/vectorShape.h"
 
 namespace llvm {
   class AllocaInst;
+  class Instruction;
   class DataLayout;
 }
 
@@ -29,10 +32,16 @@ class SROVTransform {
   VectorizationInfo & vecInfo;
   const PlatformInfo & platInfo;
 
+  // instructions created by the last run (their shapes are only tentative)
+  std::vector<const llvm::Instruction*> updateList;
+
 public:
   SROVTransform(VectorizationInfo & _vecInfo, const PlatformInfo & _platInfo);
 
   bool run();
+
+  // seeds to update the vectorization analysis after run()
+  const std::vector<const llvm::Instruction*> & getUpdateList() const { return updateList; }
 };
 
 
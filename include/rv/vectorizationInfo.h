@@ -25,9 +25,11 @@ class Value;
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace rv {
 
@@ -62,6 +64,9 @@ class VectorizationInfo {
   // fixed shapes (will be preserved through VA)
   std::set<const llvm::Value *> pinned;
 
+  // counters recorded by the region transformations (for the per-region statistics dump)
+  std::vector<std::pair<const char *, size_t>> regionStatistics;
+
 public:
   VectorizationInfo(Region &region, VectorMapping _mapping);
   VectorizationInfo(llvm::Function &parentFn, unsigned vectorWidth,
@@ -127,6 +132,12 @@ public:
   // this is required to re-run the DA
   void forgetInferredProperties();
 
+  // import all inferred information of @srcInfo (which describes a function that was cloned into this one with @cloneMap)
+  // pinned shapes are kept
+  void copyInferredProperties(const VectorizationInfo & srcInfo,
+                              const llvm::ValueToValueMapTy & cloneMap,
+                              const llvm::LoopInfo & destLI);
+
   bool isTemporalDivergent(const llvm::LoopInfo &LI,
                            const llvm::BasicBlock &ObservingBlock,
                            const llvm::Value &Val) const;
@@ -144,6 +155,14 @@ public:
   void dropPredicate(const llvm::BasicBlock &block);
   void remapPredicate(llvm::Value &dest, llvm::Value &old);
 
+  // transformation statistics of this region
+  void addRegionStatistic(const char *name, size_t count) {
+    regionStatistics.emplace_back(name, count);
+  }
+  const decltype(regionStatistics) &getRegionStatistics() const {
+    return regionStatistics;
+  }
+
   // print
   void dump() const;
   void print(llvm::raw_ostream &out) const;
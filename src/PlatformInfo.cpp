@@ -16,6 +16,7 @@
 
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Module.h>
+#include <llvm/IR/ValueHandle.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/TypeSize.h>
 
@@ -55,7 +56,7 @@ GetBuiltinMapping(Function & F, VectorMapping & KnownMapping) {
 
 
 void
-PlatformInfo::registerDeclareSIMDFunction(Function & F) {
+PlatformInfo::registerDeclareSIMDFunction(Function & F) const {
   auto attribSet = F.getAttributes().getFnAttributes();
   // parse SIMD signatures
   std::vector<VectorMapping> wfvJobs;
@@ -67,30 +68,61 @@ PlatformInfo::registerDeclareSIMDFunction(Function & F) {
 
     VectorMapping vecMapping;
     if (!parseVectorMapping(F, attribText, vecMapping, true)) continue;
-    addMapping(std::move(vecMapping));
+    if (listResolver->addMapping(std::move(vecMapping))) invalidateResolverCache();
   }
 }
 
 void
-PlatformInfo::addMapping(VectorMapping&& mapping) { listResolver->addMapping(std::move(mapping)); }
+PlatformInfo::addMapping(VectorMapping&& mapping) {
+  if (listResolver->addMapping(std::move(mapping))) invalidateResolverCache();
+}
+
+// forgets the mappings of a registered function when it is deleted
+class PlatformInfo::RegisteredFunctionVH : public CallbackVH {
+  const PlatformInfo & platInfo;
+
+public:
+  RegisteredFunctionVH(const PlatformInfo & _platInfo, Function & F)
+  : CallbackVH(&F)
+  , platInfo(_platInfo)
+  {}
+
+  void deleted() override {
+    // this erases (and destroys) the handle - do not touch it afterwards
+    platInfo.forgetFunction(*cast<Function>(getValPtr()));
+  }
+};
 
 void
-PlatformInfo::addIntrinsicMappings() {
-  //
-  for (Function & func : getModule()) {
-    // Add mappings for known C++ ABI / stdlib functions (free)
-    VectorMapping builtinMapping;
-    if (GetBuiltinMapping(func, builtinMapping)) {
-      addMapping(std::move(builtinMapping));
-      continue;
-    }
-
-    // is this an RV intrinsic?
-    RVIntrinsic id = GetIntrinsicID(func);
-    if (id == RVIntrinsic::Unknown) continue;
-    auto vecMapping = GetIntrinsicMapping(func, id);
-    addMapping(std::move(vecMapping));
+PlatformInfo::registerFunction(Function & func) const {
+  auto itInserted = registeredFuncs.try_emplace(&func, nullptr);
+  if (!itInserted.second) return;
+  itInserted.first->second = std::make_unique<RegisteredFunctionVH>(*this, func);
+
+  // new mappings invalidate the cached (negative) answers of the resolver cache
+  // Add mappings for known C++ ABI / stdlib functions (free)
+  VectorMapping builtinMapping;
+  if (GetBuiltinMapping(func, builtinMapping)) {
+    if (listResolver->addMapping(std::move(builtinMapping))) invalidateResolverCache();
+    return;
+  }
+
+  // is this an RV intrinsic?
+  RVIntrinsic id = GetIntrinsicID(func);
+  if (id != RVIntrinsic::Unknown) {
+    if (listResolver->addMapping(GetIntrinsicMapping(func, id))) invalidateResolverCache();
+    return;
   }
+
+  // register OpenMP "pragma omp declare simd" functions
+  registerDeclareSIMDFunction(func);
+}
+
+void
+PlatformInfo::forgetFunction(const Function & func) const {
+  listResolver->forgetAllMappingsFor(func);
+  invalidateResolverCache();
+  registeredFuncs.erase(&func);
 }
 
 PlatformInfo::PlatformInfo(Module &_mod, TargetTransformInfo *TTI,
@@ -103,19 +135,16 @@ PlatformInfo::PlatformInfo(Module &_mod, TargetTransformInfo *TTI,
 {
   resolverServices.push_back(std::unique_ptr<ResolverService>(new ListResolver(mod)));
   listResolver = static_cast<ListResolver*>(&*resolverServices[0]);
-
-  // add Rv intrinsic mappings
-  addIntrinsicMappings();
-
-  // register OpenMP "pragma omp declare simd" functions
-  for (auto & F : mod) {
-    registerDeclareSIMDFunction(F);
-  }
 }
 
 PlatformInfo::~PlatformInfo() {}
 
-void PlatformInfo::setTTI(TargetTransformInfo *TTI) { mTTI = TTI; }
+// resolvers are specific to the target features of the TTI.
+// the TTI wrapper pass hands out the same storage for every function -> always start over
+void PlatformInfo::setTTI(TargetTransformInfo *TTI) {
+  invalidateResolverCache();
+  mTTI = TTI;
+}
 
 void PlatformInfo::setTLI(TargetLibraryInfo *TLI) { mTLI = TLI; }
 
@@ -127,6 +156,47 @@ void
 PlatformInfo::addResolverService(std::unique_ptr<ResolverService>&& newResolver, bool givePrecedence) {
   auto itInsert = givePrecedence ? resolverServices.begin() : resolverServices.end();
   resolverServices.insert(itInsert, std::move(newResolver));
+  invalidateResolverCache();
+}
+
+void
+PlatformInfo::resetResolverServices() {
+  auto itList = std::find_if(resolverServices.begin(), resolverServices.end(),
+      [this](const std::unique_ptr<ResolverService> & resolver) { return &*resolver == listResolver; });
+  std::unique_ptr<ResolverService> listService = std::move(*itList);
+  resolverServices.clear();
+  resolverServices.push_back(std::move(listService));
+  invalidateResolverCache();
+}
+
+// hands out a memoized resolver (the cache and the caller share ownership)
+class CachedFunctionResolver : public FunctionResolver {
+  std::shared_ptr<FunctionResolver> cached;
+
+public:
+  CachedFunctionResolver(Module & targetModule, std::shared_ptr<FunctionResolver> _cached)
+  : FunctionResolver(targetModule)
+  , cached(_cached)
+  {}
+
+  FunctionCost requestCostEstimate() override { return cached->requestCostEstimate(); }
+  llvm::Function& requestVectorized() override { return cached->requestVectorized(); }
+  CallPredicateMode getCallSitePredicateMode() override { return cached->getCallSitePredicateMode(); }
+  int getMaskPos() override { return cached->getMaskPos(); }
+  VectorShape requestResultShape() override { return cached->requestResultShape(); }
+};
+
+static std::string
+GetResolverQueryKey(StringRef funcName, FunctionType & scaFuncTy, const VectorShapeVec & argShapes, int vectorWidth, bool hasPredicate) {
+  std::string key;
+  raw_string_ostream out(key);
+  out << funcName << ":" << (const void*) &scaFuncTy << ":" << vectorWidth << (hasPredicate ? "P" : "N");
+  for (const auto & argShape : argShapes) {
+    if (!argShape.isDefined()) out << "_u";
+    else if (argShape.isVarying()) out << "_v" << argShape.getAlignmentFirst();
+    else out << "_s" << argShape.getStride() << "a" << argShape.getAlignmentFirst();
+  }
+  return out.str();
 }
 
 std::unique_ptr<FunctionResolver>
@@ -145,11 +215,27 @@ PlatformInfo::getResolver(StringRef funcName,
     errs() << "\n";
   }
 
+  // register the callee on its first query
+  if (auto * scaFunc = mod.getFunction(funcName)) registerFunction(*scaFunc);
+
+  std::string queryKey = GetResolverQueryKey(funcName, scaFuncTy, argShapes, vectorWidth, hasPredicate);
+  auto itCached = resolverCache.find(queryKey);
+  if (itCached != resolverCache.end()) {
+    IF_DEBUG_PLAT { errs() << "(cached)\n"; }
+    if (!itCached->second) return nullptr;
+    return std::make_unique<CachedFunctionResolver>(mod, itCached->second);
+  }
+
+  std::shared_ptr<FunctionResolver> funcResolver;
   for (const auto & resolver : resolverServices) {
-    std::unique_ptr<FunctionResolver> funcResolver = resolver->resolve(funcName, scaFuncTy, argShapes, vectorWidth, hasPredicate, mod);
-    if (funcResolver) return funcResolver;
+    funcResolver = resolver->resolve(funcName, scaFuncTy, argShapes, vectorWidth, hasPredicate, mod);
+    if (funcResolver) break;
   }
-  return nullptr;
+
+  // resolvers may have added mappings (invalidating the cache) - insert afterwards
+  resolverCache[queryKey] = funcResolver;
+  if (!funcResolver) return nullptr;
+  return std::make_unique<CachedFunctionResolver>(mod, funcResolver);
 }
 
 llvm::Function &
@@ -202,10 +288,16 @@ PlatformInfo::dump() const {
 
 
 bool
-PlatformInfo::forgetMapping(const VectorMapping & mapping) { return listResolver->forgetMapping(mapping); }
+PlatformInfo::forgetMapping(const VectorMapping & mapping) {
+  invalidateResolverCache();
+  return listResolver->forgetMapping(mapping);
+}
 
 void
-PlatformInfo::forgetAllMappingsFor(const Function & scaFunc) { listResolver->forgetAllMappingsFor(scaFunc); }
+PlatformInfo::forgetAllMappingsFor(const Function & scaFunc) {
+  invalidateResolverCache();
+  listResolver->forgetAllMappingsFor(scaFunc);
+}
 
 void
 PlatformInfo::print(llvm::raw_ostream & out) const {
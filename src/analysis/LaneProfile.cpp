@@ -0,0 +1,112 @@
+//===- src/analysis/LaneProfile.cpp - lane occupancy profile --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "rv/analysis/LaneProfile.h"
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include "report.h"
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+using namespace llvm;
+
+namespace rv {
+
+static std::string
+GetSiteKey(StringRef funcName, StringRef blockName) {
+  return (funcName + "\t" + blockName).str();
+}
+
+bool
+LaneProfile::readFromFile(StringRef path) {
+  auto bufOrErr = MemoryBuffer::getFile(path);
+  if (!bufOrErr) return false;
+
+  SmallVector<StringRef, 16> lines;
+  (*bufOrErr)->getBuffer().split(lines, '\n', -1, false);
+
+  // <function> <block> <location> <kind> <width> <executions> <active lanes> <none active> <all active>
+  for (auto line : lines) {
+    SmallVector<StringRef, 9> fields;
+    line.split(fields, '\t');
+    if (fields.size() != 9) continue; // malformed
+
+    unsigned width;
+    uint64_t counts[4];
+    if (fields[4].getAsInteger(10, width)) continue;
+    bool validCounts = true;
+    for (int i = 0; i < 4; ++i) validCounts &= !fields[5 + i].getAsInteger(10, counts[i]);
+    if (!validCounts) continue;
+
+    auto & stats = sites[GetSiteKey(fields[0], fields[1])];
+    // keep the stats of one width only
+    if (stats.vectorWidth && stats.vectorWidth != width) continue;
+    stats.vectorWidth = width;
+    stats.executions += counts[0];
+    stats.activeLanes += counts[1];
+    stats.noneActive += counts[2];
+    stats.allActive += counts[3];
+  }
+
+  return true;
+}
+
+const LaneStats *
+LaneProfile::lookup(StringRef funcName, StringRef blockName) const {
+  if (blockName.empty()) return nullptr;
+  auto it = sites.find(GetSiteKey(funcName, blockName));
+  if (it == sites.end() || !it->second.executions) return nullptr;
+  return &it->second;
+}
+
+bool
+LaneProfile::pickSuccessor(const BranchInst & branch, StringRef funcName, bool onTrueLegal, bool onFalseLegal,
+                           std::function<double(const LaneStats *)> getScore, int & oDecision) const {
+  const auto * onTrueStats = lookup(funcName, branch.getSuccessor(0)->getName());
+  const auto * onFalseStats = lookup(funcName, branch.getSuccessor(1)->getName());
+  if (!onTrueStats && !onFalseStats) return false;
+
+  double trueScore = getScore(onTrueStats);
+  double falseScore = getScore(onFalseStats);
+  bool couldTransTrue = onTrueLegal && trueScore >= 0.0;
+  bool couldTransFalse = onFalseLegal && falseScore >= 0.0;
+
+  oDecision = 0;
+  if (couldTransTrue && (!couldTransFalse || trueScore > falseScore)) {
+    oDecision = -1;
+  } else if (couldTransFalse) {
+    oDecision = 1;
+  }
+  return true;
+}
+
+const LaneProfile *
+LaneProfile::getProfile() {
+  static std::once_flag loadFlag;
+  static std::unique_ptr<LaneProfile> profile;
+
+  std::call_once(loadFlag, []() {
+    const char * profilePath = getenv("RV_LANE_PROFILE_USE");
+    if (!profilePath) return;
+
+    profile.reset(new LaneProfile());
+    if (!profile->readFromFile(profilePath)) {
+      Report() << "could not read lane profile " << profilePath << "\n";
+      profile.reset();
+    }
+  });
+
+  return profile.get();
+}
+
+} // namespace rv
@@ -0,0 +1,96 @@
+//===- src/analysis/PlatformInfoAnalysis.cpp - module-level PlatformInfo --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "rv/analysis/PlatformInfoAnalysis.h"
+#include "rv/resolver/resolvers.h"
+
+#include "rvConfig.h"
+#include "report.h"
+
+#include "llvm/IR/Module.h"
+#include "llvm/InitializePasses.h"
+
+#include <sstream>
+
+using namespace llvm;
+
+namespace rv {
+
+// the config options the resolver chain depends on
+static std::string
+GetResolverConfigKey(const Config & config) {
+  std::stringstream ss;
+  ss << config.useVE << config.useSSE << config.useAVX << config.useAVX2 << config.useAVX512
+     << config.useNEON << config.useADVSIMD
+     << ":" << config.maxULPErrorBound
+     << ":" << config.enableGreedyIPV
+     << ":" << CheckFlag("RV_NO_SLEEF");
+  return ss.str();
+}
+
+PlatformInfoWrapperPass::PlatformInfoWrapperPass()
+: ImmutablePass(ID)
+, platInfo(nullptr)
+, resolverConfigKey()
+{
+  initializePlatformInfoWrapperPassPass(*PassRegistry::getPassRegistry());
+}
+
+PlatformInfo &
+PlatformInfoWrapperPass::getPlatformInfo(Function & F, TargetTransformInfo & TTI, TargetLibraryInfo & TLI, const Config & config) {
+  Module & M = *F.getParent();
+  if (!platInfo || (&platInfo->getModule() != &M)) {
+    platInfo.reset(new PlatformInfo(M, &TTI, &TLI));
+    resolverConfigKey.clear();
+  }
+
+  // per-function target info
+  platInfo->setTTI(&TTI);
+  platInfo->setTLI(&TLI);
+
+  std::string configKey = GetResolverConfigKey(config);
+  if (configKey == resolverConfigKey) return *platInfo;
+
+  // (re-)build the resolver chain
+  platInfo->resetResolverServices();
+  resolverConfigKey = configKey;
+
+  // TODO translate fast-math flag to ULP error bound
+  if (!CheckFlag("RV_NO_SLEEF")) { addSleefResolver(config, *platInfo); }
+
+  // enable inter-procedural vectorization
+  if (config.enableGreedyIPV) {
+    Report() << "Using greedy inter-procedural vectorization.\n";
+    addRecursiveResolver(config, *platInfo);
+  }
+
+  return *platInfo;
+}
+
+bool
+PlatformInfoWrapperPass::doInitialization(Module & M) {
+  platInfo.reset();
+  resolverConfigKey.clear();
+  return false;
+}
+
+bool
+PlatformInfoWrapperPass::doFinalization(Module & M) {
+  platInfo.reset();
+  resolverConfigKey.clear();
+  return false;
+}
+
+char PlatformInfoWrapperPass::ID = 0;
+
+} // namespace rv
+
+using namespace rv;
+
+INITIALIZE_PASS(PlatformInfoWrapperPass, "rv-platform-info",
+                "RV - module-level platform info", false, true)
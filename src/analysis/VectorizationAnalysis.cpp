@@ -389,6 +389,79 @@ void VectorizationAnalysis::analyze() {
   }
 }
 
+void VectorizationAnalysis::updateAnalysis(InstVec &updateList) {
+  auto &F = vecInfo.getScalarFunction();
+  assert(!F.isDeclaration());
+
+  // refine (possibly changed) argument shapes
+  adjustValueShapes(F);
+
+  // re-visit all instructions that may observe a change (shapes only rise)
+  for (const auto *inst : updateList) {
+    putOnWorklist(*inst);
+  }
+  compute(F);
+
+  promoteUndefShapesToUniform(F);
+}
+
+void VectorizationAnalysis::reanalyze(InstVec &seedList) {
+  auto &F = vecInfo.getScalarFunction();
+  assert(!F.isDeclaration());
+
+  // collect all instructions whose shapes (transitively) depend on the seeds
+  std::vector<const Instruction *> forgetList;
+  std::unordered_set<const Instruction *> visited;
+  std::vector<const Instruction *> stack(seedList.begin(), seedList.end());
+  while (!stack.empty()) {
+    const Instruction *inst = stack.back();
+    stack.pop_back();
+
+    if (!vecInfo.inRegion(*inst) || vecInfo.isPinned(*inst))
+      continue;
+    if (!visited.insert(inst).second)
+      continue;
+
+    // control divergence can not be retracted incrementally
+    if (inst->isTerminator() && inst->getNumSuccessors() > 1) {
+      if (!getShape(*inst).isVarying())
+        continue; // a uniform branch stays uniform
+
+      IF_DEBUG_VA {
+        errs() << "VA: re-analysis reaches divergent branch " << *inst
+               << ". Falling back to full analysis.\n";
+      }
+      vecInfo.forgetInferredProperties();
+      analyze();
+      return;
+    }
+
+    forgetList.push_back(inst);
+    for (const auto *user : inst->users()) {
+      if (const auto *userInst = dyn_cast<Instruction>(user))
+        stack.push_back(userInst);
+    }
+  }
+
+  IF_DEBUG_VA {
+    errs() << "VA: re-analyzing " << forgetList.size() << " instructions from "
+           << seedList.size() << " seeds\n";
+  }
+
+  // recompute the forgotten shapes from scratch
+  for (const auto *inst : forgetList) {
+    vecInfo.dropVectorShape(*inst);
+  }
+
+  adjustValueShapes(F);
+  for (const auto *inst : forgetList) {
+    putOnWorklist(*inst);
+  }
+  compute(F);
+
+  promoteUndefShapesToUniform(F);
+}
+
 static bool AllUniformOrUndefCall(const VectorizationInfo & VecInfo, const Instruction &I) {
   const auto *C = dyn_cast<CallInst>(&I);
   if (!C) return false;
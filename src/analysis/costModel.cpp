@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "rv/analysis/costModel.h"
+#include "rv/analysis/LaneProfile.h"
 
 #include "rv/PlatformInfo.h"
 #include "rv/vectorizationInfo.h"
@@ -15,9 +16,12 @@
 #include "rv/config.h"
 
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Support/InstructionCost.h"
 
 #include "rv/utils.h"
 
@@ -196,5 +200,239 @@ CostModel::pickWidthForRegion(const Region & region, size_t maxWidth) const {
   return width;
 }
 
+size_t
+CostModel::pickInterleaveCount(const Region & region, size_t vectorWidth, size_t numReductionChains) const {
+  // interleaving hides the latency of loop-carried reduction chains
+  if (numReductionChains == 0) return 1;
+
+  // there may be no SIMD mapping for the wider vectors of a call
+  bool hasCalls = false;
+  region.for_blocks([&](const BasicBlock & block) {
+      for (const auto & inst : block) {
+        if (isa<CallInst>(inst) && !isa<IntrinsicInst>(inst)) hasCalls = true;
+      }
+      return !hasCalls;
+  });
+  if (hasCalls) return 1;
+
+  // keep every accumulator and one operand per chain in vector registers
+  size_t maxCount = tti.getMaxInterleaveFactor(vectorWidth);
+  size_t numVectorRegs = tti.getNumberOfRegisters(tti.getRegisterClassForType(true));
+  size_t count = 1;
+  while (2 * count <= maxCount && 2 * count * numReductionChains * 2 <= numVectorRegs) {
+    count *= 2;
+  }
+
+  IF_DEBUG_CM { errs() << "cm: interleave count " << count << " for " << numReductionChains << " reduction chains in region " << region.str() << "\n"; }
+  return count;
+}
+
+// TTI costs are plain integers in older LLVM releases
+static double ToCost(int cost) { return cost; }
+static double ToCost(const InstructionCost & cost) {
+  auto costVal = cost.getValue();
+  if (!costVal) return 1e6; // invalid, eg not supported on this target
+  return *costVal;
+}
+
+static const auto CostKind = TargetTransformInfo::TCK_RecipThroughput;
+
+// the vector type for @scaTy (if any)
+static VectorType*
+GetVectorType(Type & scaTy, size_t width) {
+  if (!VectorType::isValidElementType(&scaTy)) return nullptr;
+  return FixedVectorType::get(&scaTy, width);
+}
+
+double
+CostModel::getScalarCost(const Instruction & inst) const {
+  return ToCost(tti.getInstructionCost(&inst, CostKind));
+}
+
+double
+CostModel::getReplicationCost(const Instruction & inst, size_t width, bool isPredicated) const {
+  double cost = width * getScalarCost(inst);
+
+  // extract operands, insert the result
+  for (const auto & op : inst.operands()) {
+    if (auto * opVecTy = GetVectorType(*op->getType(), width)) {
+      cost += ToCost(tti.getScalarizationOverhead(opVecTy, APInt::getAllOnesValue(width), false, true));
+    }
+  }
+  if (auto * resVecTy = GetVectorType(*inst.getType(), width)) {
+    cost += ToCost(tti.getScalarizationOverhead(resVecTy, APInt::getAllOnesValue(width), true, false));
+  }
+
+  // a cascade of guarded scalar instances
+  if (isPredicated) cost += width * ToCost(tti.getCFInstrCost(Instruction::Br, CostKind));
+
+  return cost;
+}
+
+double
+CostModel::getMemoryCost(const VectorizationInfo & vecInfo, const Instruction & inst, bool isPredicated) const {
+  size_t width = vecInfo.getVectorWidth();
+  const auto & DL = platInfo.getDataLayout();
+
+  auto * load = dyn_cast<LoadInst>(&inst);
+  auto * store = dyn_cast<StoreInst>(&inst);
+  const Value * ptr = load ? load->getPointerOperand() : store->getPointerOperand();
+  Type * elemTy = load ? load->getType() : store->getValueOperand()->getType();
+  llvm::Align align = load ? load->getAlign() : store->getAlign();
+  unsigned addrSpace = ptr->getType()->getPointerAddressSpace();
+
+  auto ptrShape = vecInfo.getVectorShape(*ptr);
+  bool uniformValue = load || vecInfo.getVectorShape(*store->getValueOperand()).isUniform();
+  if (ptrShape.isUniform() && uniformValue) return getScalarCost(inst);
+
+  auto * vecTy = GetVectorType(*elemTy, width);
+  if (!vecTy) return getReplicationCost(inst, width, isPredicated);
+
+  // contiguous access
+  if (ptrShape.isStrided(DL.getTypeStoreSize(elemTy))) {
+    if (isPredicated) {
+      return ToCost(tti.getMaskedMemoryOpCost(inst.getOpcode(), vecTy, align, addrSpace, CostKind));
+    }
+    return ToCost(tti.getMemoryOpCost(inst.getOpcode(), vecTy, align, addrSpace, CostKind, &inst));
+  }
+
+  // gather/scatter (or replication if the target does not support them)
+  bool hasGatherScatter = load ? tti.isLegalMaskedGather(vecTy, align) : tti.isLegalMaskedScatter(vecTy, align);
+  if (hasGatherScatter) {
+    return ToCost(tti.getGatherScatterOpCost(inst.getOpcode(), vecTy, ptr, isPredicated, align, CostKind, &inst));
+  }
+  return getReplicationCost(inst, width, isPredicated);
+}
+
+double
+CostModel::getCallCost(const VectorizationInfo & vecInfo, const CallInst & call, bool isPredicated) const {
+  size_t width = vecInfo.getVectorWidth();
+
+  auto * callee = call.getCalledFunction();
+  if (!callee) return getReplicationCost(call, width, isPredicated);
+
+  // critical sections and trivial intrinsics
+  if (IsCriticalSection(*callee)) return getScalarCost(call);
+  if (callee->isIntrinsic() && IsVectorizableFunction(*callee)) return 0.0;
+
+  VectorShapeVec argShapes;
+  for (const auto & arg : call.args()) argShapes.push_back(vecInfo.getVectorShape(*arg));
+
+  // a vector implementation of the callee is available
+  // assume it costs one scalar call per (native) vector register it occupies
+  if (platInfo.getResolver(callee->getName(), *callee->getFunctionType(), argShapes, width, isPredicated)) {
+    size_t typeBits = 0;
+    for (const auto & arg : call.args()) typeBits = std::max<size_t>(typeBits, arg->getType()->getPrimitiveSizeInBits());
+    typeBits = std::max<size_t>(typeBits, call.getType()->getPrimitiveSizeInBits());
+    size_t maxBits = std::max<size_t>(platInfo.getMaxVectorBits(), 1);
+    size_t numParts = std::max<size_t>(1, (width * typeBits + maxBits - 1) / maxBits);
+    return numParts * getScalarCost(call);
+  }
+
+  return getReplicationCost(call, width, isPredicated);
+}
+
+double
+CostModel::getVectorCost(const VectorizationInfo & vecInfo, const Instruction & inst, bool isPredicated) const {
+  size_t width = vecInfo.getVectorWidth();
+
+  if (isa<LoadInst>(inst) || isa<StoreInst>(inst)) {
+    return getMemoryCost(vecInfo, inst, isPredicated);
+  }
+
+  // uniform values are computed once per vector iteration
+  auto shape = vecInfo.getVectorShape(inst);
+  if (shape.isUniform()) {
+    // linearized control does not branch anymore
+    return getScalarCost(inst);
+  }
+
+  if (inst.isTerminator()) {
+    // folded (varying) branch, the mask is materialized instead
+    return ToCost(tti.getArithmeticInstrCost(Instruction::And, GetVectorType(*Type::getInt1Ty(inst.getContext()), width), CostKind));
+  }
+
+  if (auto * phi = dyn_cast<PHINode>(&inst)) {
+    // phis in join points of varying branches are turned into blends
+    if (!vecInfo.isJoinDivergent(*phi->getParent())) return 0.0;
+    auto * vecTy = GetVectorType(*phi->getType(), width);
+    if (!vecTy) return getReplicationCost(inst, width, false);
+    auto * maskTy = GetVectorType(*Type::getInt1Ty(inst.getContext()), width);
+    double selectCost = ToCost(tti.getCmpSelInstrCost(Instruction::Select, vecTy, maskTy, CmpInst::BAD_ICMP_PREDICATE, CostKind));
+    return (phi->getNumIncomingValues() - 1) * selectCost;
+  }
+
+  if (auto * call = dyn_cast<CallInst>(&inst)) {
+    return getCallCost(vecInfo, *call, isPredicated);
+  }
+
+  // contiguous address computation only produces the base pointer
+  if (isa<GetElementPtrInst>(inst) && shape.hasStridedShape()) {
+    return getScalarCost(inst);
+  }
+
+  auto * vecTy = GetVectorType(*inst.getType(), width);
+  if (!vecTy) return getReplicationCost(inst, width, isPredicated);
+
+  if (isa<BinaryOperator>(inst) || isa<UnaryOperator>(inst)) {
+    return ToCost(tti.getArithmeticInstrCost(inst.getOpcode(), vecTy, CostKind));
+  }
+
+  if (auto * cast = dyn_cast<CastInst>(&inst)) {
+    auto * srcVecTy = GetVectorType(*cast->getSrcTy(), width);
+    if (!srcVecTy) return getReplicationCost(inst, width, isPredicated);
+    return ToCost(tti.getCastInstrCost(inst.getOpcode(), vecTy, srcVecTy, TargetTransformInfo::CastContextHint::None, CostKind));
+  }
+
+  if (isa<CmpInst>(inst) || isa<SelectInst>(inst)) {
+    auto * opVecTy = GetVectorType(*inst.getOperand(isa<SelectInst>(inst) ? 1 : 0)->getType(), width);
+    auto * maskTy = GetVectorType(*Type::getInt1Ty(inst.getContext()), width);
+    if (!opVecTy) return getReplicationCost(inst, width, isPredicated);
+    if (isa<CmpInst>(inst)) {
+      return ToCost(tti.getCmpSelInstrCost(inst.getOpcode(), opVecTy, maskTy, cast<CmpInst>(inst).getPredicate(), CostKind));
+    }
+    return ToCost(tti.getCmpSelInstrCost(inst.getOpcode(), opVecTy, maskTy, CmpInst::BAD_ICMP_PREDICATE, CostKind));
+  }
+
+  if (isa<GetElementPtrInst>(inst)) {
+    // vector of addresses
+    auto * intPtrTy = platInfo.getDataLayout().getIntPtrType(inst.getType());
+    return inst.getNumOperands() * ToCost(tti.getArithmeticInstrCost(Instruction::Add, GetVectorType(*intPtrTy, width), CostKind));
+  }
+
+  // Otw, assume that we fall back to replication
+  return getReplicationCost(inst, width, isPredicated);
+}
+
+double
+CostModel::estimateScalarCost(const Region & region, StringRef profileFuncName) const {
+  const LaneProfile * laneProfile = profileFuncName.empty() ? nullptr : LaneProfile::getProfile();
+
+  double cost = 0.0;
+  region.for_blocks([&](const BasicBlock & block) {
+    double blockCost = 0.0;
+    for (const auto & inst : block) blockCost += getScalarCost(inst);
+
+    // scalar iterations only execute the block if their lane would be active
+    const LaneStats * stats = laneProfile ? laneProfile->lookup(profileFuncName, block.getName()) : nullptr;
+    cost += stats ? blockCost * stats->getOccupancy() : blockCost;
+    return true;
+  });
+  return cost;
+}
+
+double
+CostModel::estimateVectorCost(const VectorizationInfo & vecInfo, bool allPredicated) const {
+  double cost = 0.0;
+  vecInfo.getRegion().for_blocks([&](const BasicBlock & block) {
+    bool isPredicated = false;
+    vecInfo.getVaryingPredicateFlag(block, isPredicated);
+    isPredicated |= allPredicated;
+    for (const auto & inst : block) cost += getVectorCost(vecInfo, inst, isPredicated);
+    return true;
+  });
+  return cost;
+}
+
 
 }
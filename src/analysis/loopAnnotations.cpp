@@ -24,6 +24,9 @@ LoopMD::print(raw_ostream & out) const {
   if (vectorizeEnable.isSet()) out << "vectorizeEnable = " << vectorizeEnable.get() << ", ";
   if (minDepDist.isSet()) out << "minDepDist = " << DepDistToString(minDepDist.get()) << ", ";
   if (explicitVectorWidth.isSet()) out << "explicitVectorWidth = " << explicitVectorWidth.get() << ", ";
+  if (remainderMode.isSet()) out << "remainderMode = " << to_string(remainderMode.get()) << ", ";
+  if (reductionMode.isSet()) out << "reductionMode = " << to_string(reductionMode.get()) << ", ";
+  if (interleaveCount.isSet()) out << "interleaveCount = " << interleaveCount.get() << ", ";
   out << "}";
   return out;
 }
@@ -33,6 +36,16 @@ LoopMD::dump() const {
   print(errs()) << "\n";
 }
 
+const char*
+to_string(RemainderMode mode) {
+  switch (mode) {
+    case RemainderMode::Scalar: return "scalar";
+    case RemainderMode::MaskedEpilogue: return "masked";
+    case RemainderMode::Predicated: return "predicated";
+  }
+  abort();
+}
+
 std::string
 DepDistToString(iter_t depDist) {
   if (depDist == ParallelDistance) {
@@ -67,6 +80,25 @@ OptimisticJoin(LoopMD && A, LoopMD && B) {
     md.explicitVectorWidth = std::min<iter_t>(A.explicitVectorWidth.safeGet(ParallelDistance), B.explicitVectorWidth.safeGet(ParallelDistance));
   }
 
+  // RV annotations (B) take precedence
+  if (B.remainderMode.isSet()) {
+    md.remainderMode = B.remainderMode.get();
+  } else if (A.remainderMode.isSet()) {
+    md.remainderMode = A.remainderMode.get();
+  }
+
+  if (B.reductionMode.isSet()) {
+    md.reductionMode = B.reductionMode.get();
+  } else if (A.reductionMode.isSet()) {
+    md.reductionMode = A.reductionMode.get();
+  }
+
+  if (B.interleaveCount.isSet()) {
+    md.interleaveCount = B.interleaveCount.get();
+  } else if (A.interleaveCount.isSet()) {
+    md.interleaveCount = A.interleaveCount.get();
+  }
+
   return md;
 }
 
@@ -116,6 +148,13 @@ GetLoopAnnotation(llvm::Loop & L) {
     } else if (text.equals("llvm.loop.vectorize.width")) {
       llvmAnnot.explicitVectorWidth = cast<ConstantInt>(Cst->getValue())->getSExtValue();
 
+    } else if (text.equals("llvm.loop.interleave.count")) {
+      llvmAnnot.interleaveCount = cast<ConstantInt>(Cst->getValue())->getSExtValue();
+
+    } else if (text.equals("llvm.loop.vectorize.predicate.enable")) {
+      const bool predicateEnable = !Cst->getValue()->isNullValue();
+      llvmAnnot.remainderMode = predicateEnable ? RemainderMode::Predicated : RemainderMode::Scalar;
+
     } else if (text.equals("rv.loop.vectorize.enable")) {
       const bool vectorizeEnable = !Cst->getValue()->isNullValue();
       rvAnnot.vectorizeEnable = vectorizeEnable;
@@ -129,6 +168,23 @@ GetLoopAnnotation(llvm::Loop & L) {
 
     } else if (text.equals("rv.loop.mindepdist")) {
       rvAnnot.minDepDist = cast<ConstantInt>(Cst->getValue())->getSExtValue();
+
+    } else if (text.equals("rv.loop.vectorize.remainder")) {
+      // 0 (scalar), 1 (masked epilogue), 2 (predicated loop)
+      auto modeVal = cast<ConstantInt>(Cst->getValue())->getZExtValue();
+      if (modeVal <= (uint64_t) RemainderMode::Predicated) {
+        rvAnnot.remainderMode = (RemainderMode) modeVal;
+      }
+
+    } else if (text.equals("rv.loop.vectorize.reduction")) {
+      // 0 (auto), 1 (shuffle tree), 2 (reduce intrinsics), 3 (ordered)
+      auto modeVal = cast<ConstantInt>(Cst->getValue())->getZExtValue();
+      if (modeVal <= (uint64_t) ReductionMode::Ordered) {
+        rvAnnot.reductionMode = (ReductionMode) modeVal;
+      }
+
+    } else if (text.equals("rv.loop.interleave.count")) {
+      rvAnnot.interleaveCount = cast<ConstantInt>(Cst->getValue())->getSExtValue();
     }
   }
 
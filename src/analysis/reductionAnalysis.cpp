@@ -56,6 +56,9 @@ InferRedKind(Instruction & inst, Reduction & red) {
     case Instruction::And:
       return RedKind::And;
 
+    case Instruction::Xor:
+      return RedKind::Xor;
+
   // preserving operations
     case Instruction::Select:
     case Instruction::PHI:
@@ -92,7 +95,11 @@ Reduction::print(raw_ostream & out) const {
     levelLoop ? "(" + std::to_string(levelLoop->getLoopDepth()) + ") " + levelLoop->getName().str()
               : "<none>";
 
-   out << "Reduction { levelLoop = " << loopName << " redKind " << to_string(kind) << " elems:\n";
+   out << "Reduction { levelLoop = " << loopName << " redKind " << to_string(kind) << (isScan ? " scan" : "") << (isCompact ? " compact" : "");
+   if (isPayload) {
+     out << (keyRed ? " payload of " + to_string(keyRed->kind).str() : " last value") << (pickFirst ? " (first)" : " (last)");
+   }
+   out << " elems:\n";
    for (const Instruction * elem : elements) {
      out << "- " << *elem << "\n";
    }
@@ -282,10 +289,73 @@ ReductionAnalysis::isHeaderPhi(Instruction & inst, Loop & loop) const {
 using InstInt = std::pair<Instruction*, int>;
 using NodeStack = std::vector<InstInt>;
 
+// whether @inst is the condition of a min/max select on the chain (other selects may pick a payload with it)
+static bool
+IsMinMaxCondition(Instruction & inst, Reduction & red) {
+  if (!isa<ICmpInst>(inst)) return false;
+  bool onChain = false;
+  for (auto * user : inst.users()) {
+    auto * sel = dyn_cast<SelectInst>(user);
+    if (!sel || sel->getCondition() != &inst) return false;
+    onChain |= red.contains(*sel);
+  }
+  return onChain;
+}
+
+// match the integer min/max idiom (a PRED b) ? a : b where exactly one of a, b is carried by the chain
+static RedKind
+MatchMinMaxKind(SelectInst & sel, Reduction & red) {
+  auto * cmp = dyn_cast<ICmpInst>(sel.getCondition());
+  if (!cmp || !red.contains(*cmp) || !IsMinMaxCondition(*cmp, red)) return RedKind::Top;
+
+  Value * lhs = sel.getTrueValue();
+  Value * rhs = sel.getFalseValue();
+  auto * lhsInst = dyn_cast<Instruction>(lhs);
+  auto * rhsInst = dyn_cast<Instruction>(rhs);
+  bool lhsOnChain = lhsInst && red.contains(*lhsInst);
+  bool rhsOnChain = rhsInst && red.contains(*rhsInst);
+  if (lhsOnChain == rhsOnChain) return RedKind::Top;
+
+  // normalize to (lhs PRED rhs)
+  auto pred = cmp->getPredicate();
+  if (cmp->getOperand(0) == rhs && cmp->getOperand(1) == lhs) {
+    pred = CmpInst::getSwappedPredicate(pred);
+  } else if (cmp->getOperand(0) != lhs || cmp->getOperand(1) != rhs) {
+    return RedKind::Top;
+  }
+
+  switch (pred) {
+    case CmpInst::ICMP_SGT:
+    case CmpInst::ICMP_SGE:
+      return RedKind::SMax;
+    case CmpInst::ICMP_UGT:
+    case CmpInst::ICMP_UGE:
+      return RedKind::UMax;
+    case CmpInst::ICMP_SLT:
+    case CmpInst::ICMP_SLE:
+      return RedKind::SMin;
+    case CmpInst::ICMP_ULT:
+    case CmpInst::ICMP_ULE:
+      return RedKind::UMin;
+    default:
+      return RedKind::Top;
+  }
+}
+
 static RedKind
 ClassifyReduction(Reduction & red) {
   RedKind kind = RedKind::Bot;
   for (auto * inst : red.elements) {
+    // min/max reductors are classified by their select
+    auto * sel = dyn_cast<SelectInst>(inst);
+    auto * condInst = sel ? dyn_cast<Instruction>(sel->getCondition()) : nullptr;
+    if (IsMinMaxCondition(*inst, red)) continue;
+    if (condInst && red.contains(*condInst)) {
+      kind = JoinKinds(kind, MatchMinMaxKind(*sel, red));
+      if (kind == RedKind::Top) return kind;
+      continue;
+    }
+
     auto nodeKind = InferRedKind(*inst, red);
 
     if (nodeKind != RedKind::Bot) {
@@ -311,6 +381,244 @@ ClassifyReduction(Reduction & red) {
   return kind;
 }
 
+// the chain of @red is a single reductor of @phi whose running value is used inside @loop (prefix scan)
+static bool
+MatchScan(Reduction & red, PHINode & phi, Loop & loop) {
+  if (red.kind == RedKind::Top || red.kind == RedKind::Bot) return false;
+
+  // the reductor is the latch update and executes in every iteration
+  auto * latch = loop.getLoopLatch();
+  if (!latch || phi.getParent() != loop.getHeader()) return false;
+  auto * reductor = dyn_cast<Instruction>(phi.getIncomingValueForBlock(latch));
+  if (!reductor || !red.contains(*reductor)) return false;
+  if (reductor->getParent() != loop.getHeader() && reductor->getParent() != latch) return false;
+
+  // no other instructions on the chain (except for the condition of a min/max reductor)
+  for (auto * elem : red.elements) {
+    if (elem == &phi || elem == reductor) continue;
+    if (IsMinMaxCondition(*elem, red)) continue;
+    return false;
+  }
+
+  bool hasScanUser = false;
+  for (auto * elem : red.elements) {
+    for (auto * user : elem->users()) {
+      auto * userInst = dyn_cast<Instruction>(user);
+      if (!userInst || red.contains(*userInst)) continue;
+
+      // only the final value of the reductor may leave the loop
+      if (!loop.contains(userInst->getParent())) {
+        if (elem != reductor) return false;
+        continue;
+      }
+      if (elem != &phi && elem != reductor) return false;
+
+      // exclusive scan values are derived from the inclusive ones (the user must come after the reductor)
+      if (elem == &phi) {
+        bool afterReductor = (userInst->getParent() == reductor->getParent())
+                           ? reductor->comesBefore(userInst)
+                           : reductor->getParent() == loop.getHeader();
+        if (!afterReductor || isa<PHINode>(userInst)) return false;
+      }
+      hasScanUser = true;
+    }
+  }
+
+  return hasScanUser;
+}
+
+// @user addresses stores of @incBlock with the running value of @phi (the base pointer is invariant in @loop)
+static bool
+IsCompactStoreAddress(Instruction & user, PHINode & phi, BasicBlock & incBlock, Loop & loop) {
+  // optional extension of the index
+  Value * idxVal = &phi;
+  Instruction * addrInst = &user;
+  if (isa<SExtInst>(user) || isa<ZExtInst>(user)) {
+    if (!user.hasOneUse()) return false;
+    idxVal = &user;
+    addrInst = cast<Instruction>(*user.user_begin());
+  }
+
+  auto * gep = dyn_cast<GetElementPtrInst>(addrInst);
+  if (!gep || gep->getNumIndices() != 1 || gep->getOperand(1) != idxVal) return false;
+  if (!loop.isLoopInvariant(gep->getPointerOperand())) return false;
+
+  // consecutive elements are written in the order of the increments
+  for (auto * gepUser : gep->users()) {
+    auto * store = dyn_cast<StoreInst>(gepUser);
+    if (!store || !store->isSimple() || store->getPointerOperand() != gep) return false;
+    if (store->getParent() != &incBlock) return false;
+    if (store->getValueOperand()->getType() != gep->getSourceElementType()) return false;
+  }
+  return !gep->use_empty();
+}
+
+// the chain of @red increments @phi by one under a condition and the running value only addresses stores (stream compaction)
+static bool
+MatchCompactIndex(Reduction & red, PHINode & phi, Loop & loop) {
+  if (red.kind != RedKind::Add || !phi.getType()->isIntegerTy()) return false;
+
+  auto * latch = loop.getLoopLatch();
+  if (!latch || phi.getParent() != loop.getHeader()) return false;
+  auto * latchInst = dyn_cast<Instruction>(phi.getIncomingValueForBlock(latch));
+  if (!latchInst) return false;
+
+  // a single increment, all other elements merge the old and the incremented value
+  Instruction * inc = nullptr;
+  for (auto * elem : red.elements) {
+    if (elem == &phi) continue;
+
+    if (auto * mergePhi = dyn_cast<PHINode>(elem)) {
+      for (Value * inVal : mergePhi->incoming_values()) {
+        auto * inInst = dyn_cast<Instruction>(inVal);
+        if (!inInst || !red.contains(*inInst)) return false;
+      }
+      continue;
+    }
+    if (auto * sel = dyn_cast<SelectInst>(elem)) {
+      auto * trueInst = dyn_cast<Instruction>(sel->getTrueValue());
+      auto * falseInst = dyn_cast<Instruction>(sel->getFalseValue());
+      if (!trueInst || !falseInst || !red.contains(*trueInst) || !red.contains(*falseInst)) return false;
+      continue;
+    }
+
+    if (inc || elem->getOpcode() != Instruction::Add) return false;
+    auto * one = dyn_cast<ConstantInt>(elem->getOperand(1));
+    if (elem->getOperand(0) != &phi || !one || !one->isOne()) return false;
+    inc = elem;
+  }
+  if (!inc || inc == latchInst) return false;
+
+  bool hasStore = false;
+  for (auto * elem : red.elements) {
+    for (auto * user : elem->users()) {
+      auto * userInst = dyn_cast<Instruction>(user);
+      if (!userInst) return false;
+      if (red.contains(*userInst)) continue;
+
+      // only the final index may leave the loop
+      if (!loop.contains(userInst->getParent())) {
+        if (elem != latchInst) return false;
+        continue;
+      }
+      if (elem != &phi || !IsCompactStoreAddress(*userInst, phi, *inc->getParent(), loop)) return false;
+      hasStore = true;
+    }
+  }
+
+  return hasStore;
+}
+
+bool
+ReductionAnalysis::dependsOnRecurrence(Value & val, Loop & loop) const {
+  std::set<Instruction*> seen;
+  std::vector<Instruction*> stack;
+  if (auto * inst = dyn_cast<Instruction>(&val)) stack.push_back(inst);
+
+  while (!stack.empty()) {
+    auto * inst = stack.back();
+    stack.pop_back();
+    if (!loop.contains(inst->getParent())) continue;
+    if (!seen.insert(inst).second) continue;
+
+    if (isa<PHINode>(inst) && inst->getParent() == loop.getHeader()) {
+      if (getStrideInfo(*inst)) continue;
+      return true;
+    }
+
+    for (Value * opVal : inst->operands()) {
+      if (auto * opInst = dyn_cast<Instruction>(opVal)) stack.push_back(opInst);
+    }
+  }
+  return false;
+}
+
+bool
+ReductionAnalysis::matchPayload(Reduction & red, PHINode & phi, Loop & loop) {
+  auto * latch = loop.getLoopLatch();
+  if (!latch || red.elements.size() != 2) return false;
+  auto * sel = dyn_cast<SelectInst>(phi.getIncomingValueForBlock(latch));
+  if (!sel || !red.contains(*sel)) return false;
+
+  // one select operand keeps the payload, the other one updates it
+  bool updateOnTrue;
+  if (sel->getFalseValue() == &phi) {
+    updateOnTrue = true;
+  } else if (sel->getTrueValue() == &phi) {
+    updateOnTrue = false;
+  } else {
+    return false;
+  }
+  Value * updateVal = updateOnTrue ? sel->getTrueValue() : sel->getFalseValue();
+  if (updateVal == &phi || dependsOnRecurrence(*updateVal, loop)) return false;
+
+  // the payload may only leave the loop through the select
+  for (auto * user : phi.users()) {
+    if (user != sel) return false;
+  }
+  for (auto * user : sel->users()) {
+    auto * userInst = cast<Instruction>(user);
+    if (userInst != &phi && loop.contains(userInst->getParent())) return false;
+  }
+
+  // conditional last value
+  auto * condInst = dyn_cast<Instruction>(sel->getCondition());
+  auto * condRed = condInst ? getReductionInfo(*condInst) : nullptr;
+  if (!condRed) {
+    if (dependsOnRecurrence(*sel->getCondition(), loop)) return false;
+    red.isPayload = true;
+    red.keyRed = nullptr;
+    red.pickFirst = false;
+    return true;
+  }
+
+  // arg-min/arg-max: the condition updates the key reduction
+  switch (condRed->kind) {
+    case RedKind::SMax:
+    case RedKind::UMax:
+    case RedKind::SMin:
+    case RedKind::UMin:
+      break;
+    default:
+      return false;
+  }
+  if (condRed->isScan) return false;
+
+  SelectInst * keySel = nullptr;
+  for (auto * user : condInst->users()) {
+    auto * userSel = dyn_cast<SelectInst>(user);
+    if (userSel && condRed->contains(*userSel)) keySel = userSel;
+  }
+  if (!keySel) return false;
+
+  // the key select is the latch update of the key phi
+  PHINode * keyPhi = nullptr;
+  for (auto * elem : condRed->elements) {
+    auto * elemPhi = dyn_cast<PHINode>(elem);
+    if (elemPhi && elemPhi->getParent() == loop.getHeader()) keyPhi = elemPhi;
+  }
+  if (!keyPhi || keyPhi->getIncomingValueForBlock(latch) != keySel) return false;
+
+  // the payload updates with the key
+  auto * keyTrueInst = dyn_cast<Instruction>(keySel->getTrueValue());
+  bool keyUpdateOnTrue = !(keyTrueInst && condRed->contains(*keyTrueInst));
+  if (keyUpdateOnTrue != updateOnTrue) return false;
+
+  // normalize the compare to (newKey PRED oldKey)
+  auto * cmp = cast<ICmpInst>(condInst);
+  Value * newKey = keyUpdateOnTrue ? keySel->getTrueValue() : keySel->getFalseValue();
+  auto pred = cmp->getPredicate();
+  if (cmp->getOperand(0) != newKey) pred = CmpInst::getSwappedPredicate(pred);
+  bool isStrict = pred == CmpInst::ICMP_SGT || pred == CmpInst::ICMP_SLT ||
+                  pred == CmpInst::ICMP_UGT || pred == CmpInst::ICMP_ULT;
+
+  red.isPayload = true;
+  red.keyRed = condRed;
+  // the key updates on (newKey PRED oldKey) or on its negation
+  red.pickFirst = isStrict == keyUpdateOnTrue;
+  return true;
+}
+
 void
 ReductionAnalysis::analyze(Loop & hostLoop) {
   clear();
@@ -423,6 +731,8 @@ ReductionAnalysis::analyze(Loop & hostLoop) {
       red->kind = ClassifyReduction(*red);
     }
     red->levelLoop = &hostLoop;
+    red->isScan = MatchScan(*red, *seedPhi, hostLoop);
+    red->isCompact = !red->isScan && MatchCompactIndex(*red, *seedPhi, hostLoop);
 
     // register with the analysis
     for (auto * inst : red->elements) {
@@ -431,6 +741,15 @@ ReductionAnalysis::analyze(Loop & hostLoop) {
 
     IF_DEBUG_RED { red->dump(); }
   }
+
+  // pair the remaining recurrences with their key reductions
+  for (auto * seedPhi : seedNodes) {
+    auto * red = getReductionInfo(*seedPhi);
+    if (!red || red->kind != RedKind::Bot) continue;
+    if (matchPayload(*red, *seedPhi, hostLoop)) {
+      IF_DEBUG_RED { errs() << "red: paired: "; red->dump(); }
+    }
+  }
 }
 
 StridePattern *
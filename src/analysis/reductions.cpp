@@ -53,9 +53,21 @@ to_string(RedKind red) {
     case RedKind::UMax: return "UMax";
     case RedKind::SMin: return "SMin";
     case RedKind::UMin: return "UMin";
+    case RedKind::Xor: return "Xor";
   }
 }
 
+const char*
+to_string(ReductionMode mode) {
+  switch (mode) {
+    case ReductionMode::Auto: return "auto";
+    case ReductionMode::Tree: return "tree";
+    case ReductionMode::Intrinsic: return "intrinsic";
+    case ReductionMode::Ordered: return "ordered";
+  }
+  llvm_unreachable("unrecognized reduction mode");
+}
+
 bool
 from_string(StringRef redKindText, RedKind & oRedKind) {
   for (int64_t itRed = (int64_t) RedKind::Enum_Begin;
@@ -74,9 +86,9 @@ Constant&
 GetNeutralElement_fp(RedKind redKind, Type & chainTy) {
   bool isDouble = chainTy.isDoubleTy();
   const double maxDouble = std::numeric_limits<double>::max();
-  const double minDouble = std::numeric_limits<double>::min();
+  const double minDouble = std::numeric_limits<double>::lowest();
   const double maxFloat = std::numeric_limits<float>::max();
-  const double minFloat = std::numeric_limits<float>::min();
+  const double minFloat = std::numeric_limits<float>::lowest();
 
   switch(redKind) {
     default:
@@ -101,7 +113,6 @@ GetNeutralElement_fp(RedKind redKind, Type & chainTy) {
 Constant&
 GetNeutralElement_int(RedKind redKind, Type & chainTy) {
   uint32_t numBits = chainTy.getIntegerBitWidth();
-  uint64_t highestBitSet = 1 << (numBits - 1);
 
   switch (redKind) {
   default:
@@ -113,15 +124,16 @@ GetNeutralElement_int(RedKind redKind, Type & chainTy) {
   case RedKind::And:
     return *ConstantInt::getAllOnesValue(&chainTy);
   case RedKind::Or:
+  case RedKind::Xor:
     return *ConstantInt::getNullValue(&chainTy);
   case RedKind::UMax:
     return *ConstantInt::get(&chainTy, 0); // 00..00
   case RedKind::SMax:
-    return *ConstantInt::get(&chainTy, highestBitSet, true); // 10..00
+    return *ConstantInt::get(chainTy.getContext(), APInt::getSignedMinValue(numBits)); // 10..00
   case RedKind::UMin:
     return *ConstantInt::getAllOnesValue(&chainTy); // 1..11
   case RedKind::SMin:
-    return *ConstantInt::get(&chainTy, 0 ^ highestBitSet); // 01..11
+    return *ConstantInt::get(chainTy.getContext(), APInt::getSignedMaxValue(numBits)); // 01..11
   }
 }
 
@@ -154,6 +166,9 @@ InferInstRedKind(Instruction & inst) {
     case Instruction::And:
       return RedKind::And;
 
+    case Instruction::Xor:
+      return RedKind::Xor;
+
   // preserving operations
     case Instruction::Select:
     case Instruction::PHI:
@@ -22,6 +22,8 @@ using namespace llvm;
 namespace {
   const char* rv_atomic_string = "rv_atomic";
   const char* rv_redkind_string  = "rv_redkind";
+  const char* rv_align_string  = "rv_align";
+  const char* rv_redmode_string  = "rv_redmode";
 }
 
 namespace rv {
@@ -65,4 +67,40 @@ ReadReductionHint(const llvm::PHINode & loopHeaderPhi) {
   return kind;
 }
 
+void
+SetReductionModeHint(llvm::PHINode & loopHeaderPhi, ReductionMode mode) {
+  auto & ctx = loopHeaderPhi.getContext();
+  auto * modeNode = ConstantAsMetadata::get(ConstantInt::get(Type::getInt32Ty(ctx), (int) mode));
+  loopHeaderPhi.setMetadata(rv_redmode_string, MDNode::get(ctx, modeNode));
+}
+
+ReductionMode
+ReadReductionModeHint(const llvm::PHINode & loopHeaderPhi) {
+  auto * boxedHint = loopHeaderPhi.getMetadata(rv_redmode_string);
+  if (!boxedHint) return ReductionMode::Auto; // unknown
+  assert(boxedHint->getNumOperands() >= 1);
+
+  auto * modeConst = mdconst::dyn_extract<ConstantInt>(boxedHint->getOperand(0));
+  assert(modeConst);
+  return (ReductionMode) modeConst->getZExtValue();
+}
+
+void
+SetAlignmentHint(llvm::Instruction & memInst, unsigned alignment) {
+  auto & ctx = memInst.getContext();
+  auto * alignNode = ConstantAsMetadata::get(ConstantInt::get(Type::getInt32Ty(ctx), alignment));
+  memInst.setMetadata(rv_align_string, MDNode::get(ctx, alignNode));
+}
+
+unsigned
+ReadAlignmentHint(const llvm::Instruction & memInst) {
+  auto * boxedHint = memInst.getMetadata(rv_align_string);
+  if (!boxedHint) return 1; // unknown
+  assert(boxedHint->getNumOperands() >= 1);
+
+  auto * alignConst = mdconst::dyn_extract<ConstantInt>(boxedHint->getOperand(0));
+  assert(alignConst);
+  return alignConst->getZExtValue();
+}
+
 }
@@ -42,10 +42,11 @@ Config::Config()
 
 // backend defaults
 , scalarizeIndexComputation(true)
-, useScatterGatherIntrinsics(true)
+, useScatterGatherIntrinsics(!CheckFlag("RV_NO_GATHER"))
 , enableMaskedMove(true)
-, enableInterleaved(false)
+, enableInterleaved(CheckFlag("RV_INTERLEAVED"))
 , useSafeDivisors(true)
+, enableLaneProfiling(CheckFlag("RV_PROFILE_LANES"))
 
 // optimization defaults
 , enableSplitAllocas(!CheckFlag("RV_DISABLE_SPLITALLOCAS"))
@@ -55,9 +56,15 @@ Config::Config()
 , enableHeuristicBOSCC(CheckFlag("RV_EXP_BOSCC"))
 , enableCoherentIF(CheckFlag("RV_EXP_CIF"))
 , enableOptimizedBlends(!CheckFlag("RV_NO_BLENDOPT"))
+, enableMaskedRemainder(CheckFlag("RV_MASKED_REMAINDER"))
+, enableLoopVersioning(CheckFlag("RV_LOOP_VERSIONING"))
+, enableLoopInterleaving(CheckFlag("RV_LOOP_INTERLEAVE"))
 
 // enable greedy inter-procedural vectorization
 , enableGreedyIPV(CheckFlag("RV_IPV"))
+
+// -time-passes timers
+, enablePhaseTimers(true)
 , maxULPErrorBound(10)
 
 // feature flags
@@ -185,7 +192,8 @@ static void
 printNativeFlags(const Config & config, llvm::raw_ostream & out) {
    out << "nat:  useScatterGather = " << config.useScatterGatherIntrinsics
        << ", enableInterleaved = " << config.enableInterleaved
-       << ", useSafeDiv = " << config.useSafeDivisors;
+       << ", useSafeDiv = " << config.useSafeDivisors
+       << ", enableLaneProfiling = " << config.enableLaneProfiling;
 }
 
 static void
@@ -196,6 +204,9 @@ printOptFlags(const Config & config, llvm::raw_ostream & out) {
         << ", enableHeuristicBOSCC = " << config.enableHeuristicBOSCC
         << ", enableCoherentIF = " << config.enableCoherentIF
         << ", enableOptimizedBlends = " << config.enableOptimizedBlends
+        << ", enableMaskedRemainder = " << config.enableMaskedRemainder
+        << ", enableLoopVersioning = " << config.enableLoopVersioning
+        << ", enableLoopInterleaving = " << config.enableLoopInterleaving
         << ", enableIRPolish = " << config.enableIRPolish
         << ", greedyIPV = " << config.enableGreedyIPV
         << ", maxULPErrorBound = " << ulp_to_string(config.maxULPErrorBound);
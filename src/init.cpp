@@ -25,6 +25,7 @@ public:
     llvm::initializeLoopVectorizerPass(Registry);
     llvm::initializeIRPolisherWrapperPass(Registry);
     llvm::initializeWFVPassPass(Registry);
+    llvm::initializePlatformInfoWrapperPassPass(Registry);
   }
 };
 static StaticInitializer InitializeEverything;
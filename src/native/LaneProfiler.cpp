@@ -0,0 +1,134 @@
+//===- src/native/LaneProfiler.cpp - lane occupancy instrumentation --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+
+#include "LaneProfiler.h"
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+
+#include <sstream>
+
+using namespace llvm;
+
+static const char * DumpFuncName = "rv.laneprof.dump";
+static const char * DumpBlockName = "dump";
+
+namespace rv {
+
+LaneProfiler::LaneProfiler(Module & _mod)
+: mod(_mod)
+{}
+
+BasicBlock &
+LaneProfiler::requestDumpBlock() {
+  auto * dumpFunc = mod.getFunction(DumpFuncName);
+  if (dumpFunc) {
+    for (auto & block : *dumpFunc) {
+      if (block.getName() == DumpBlockName) return block;
+    }
+    abort(); // not a dump function we generated
+  }
+
+  auto & ctx = mod.getContext();
+  auto * voidTy = Type::getVoidTy(ctx);
+  auto * i8PtrTy = Type::getInt8PtrTy(ctx);
+  auto * i32Ty = Type::getInt32Ty(ctx);
+
+  auto getenvFunc = mod.getOrInsertFunction("getenv", FunctionType::get(i8PtrTy, {i8PtrTy}, false));
+  auto fopenFunc = mod.getOrInsertFunction("fopen", FunctionType::get(i8PtrTy, {i8PtrTy, i8PtrTy}, false));
+  auto fcloseFunc = mod.getOrInsertFunction("fclose", FunctionType::get(i32Ty, {i8PtrTy}, false));
+
+  dumpFunc = Function::Create(FunctionType::get(voidTy, false), GlobalValue::InternalLinkage, DumpFuncName, &mod);
+  auto * entryBlock = BasicBlock::Create(ctx, "entry", dumpFunc);
+  auto * dumpBlock = BasicBlock::Create(ctx, DumpBlockName, dumpFunc);
+  auto * exitBlock = BasicBlock::Create(ctx, "exit", dumpFunc);
+
+  // open the profile
+  IRBuilder<> builder(entryBlock);
+  auto * envPath = builder.CreateCall(getenvFunc, {builder.CreateGlobalStringPtr("RV_LANE_PROFILE_FILE")}, "env.path");
+  auto * hasEnvPath = builder.CreateIsNotNull(envPath);
+  auto * path = builder.CreateSelect(hasEnvPath, envPath, builder.CreateGlobalStringPtr("rv_lane_profile.txt"), "path");
+  auto * file = builder.CreateCall(fopenFunc, {path, builder.CreateGlobalStringPtr("a")}, "file");
+  builder.CreateCondBr(builder.CreateIsNull(file), exitBlock, dumpBlock);
+
+  // sites are printed here (before the fclose)
+  builder.SetInsertPoint(dumpBlock);
+  builder.CreateCall(fcloseFunc, {file});
+  builder.CreateBr(exitBlock);
+
+  builder.SetInsertPoint(exitBlock);
+  builder.CreateRetVoid();
+
+  appendToGlobalDtors(mod, dumpFunc, 0);
+  return *dumpBlock;
+}
+
+void
+LaneProfiler::addSite(IRBuilder<> & builder, Value & numActive,
+                      StringRef funcName, StringRef blockName,
+                      StringRef location, StringRef kind, unsigned vectorWidth) {
+  auto & ctx = mod.getContext();
+  auto * i64Ty = Type::getInt64Ty(ctx);
+  auto * counterTy = ArrayType::get(i64Ty, 4);
+
+  // {executions, active lanes, no lane active, all lanes active}
+  auto * counters = new GlobalVariable(mod, counterTy, false, GlobalValue::PrivateLinkage,
+                                       ConstantAggregateZero::get(counterTy), "rv.laneprof.counters");
+
+  auto * activeLanes = builder.CreateZExtOrTrunc(&numActive, i64Ty);
+  auto * isEmpty = builder.CreateICmpEQ(activeLanes, ConstantInt::get(i64Ty, 0));
+  auto * isFull = builder.CreateICmpEQ(activeLanes, ConstantInt::get(i64Ty, vectorWidth));
+  Value * increments[] = {ConstantInt::get(i64Ty, 1), activeLanes,
+                          builder.CreateZExt(isEmpty, i64Ty), builder.CreateZExt(isFull, i64Ty)};
+
+  for (unsigned i = 0; i < 4; ++i) {
+    auto * counterPtr = builder.CreateConstInBoundsGEP2_32(counterTy, counters, 0, i);
+    auto * count = builder.CreateLoad(i64Ty, counterPtr, "rv.laneprof.count");
+    builder.CreateStore(builder.CreateAdd(count, increments[i]), counterPtr);
+  }
+
+  // print the counters at exit
+  auto & dumpBlock = requestDumpBlock();
+  auto * i8PtrTy = Type::getInt8PtrTy(ctx);
+  auto fprintfFunc = mod.getOrInsertFunction("fprintf", FunctionType::get(Type::getInt32Ty(ctx), {i8PtrTy, i8PtrTy}, true));
+
+  auto & closeCall = *dumpBlock.getTerminator()->getPrevNode();
+  auto * file = cast<CallInst>(closeCall).getArgOperand(0);
+
+  IRBuilder<> dumpBuilder(&closeCall);
+  auto * format = dumpBuilder.CreateGlobalStringPtr("%s\t%s\t%s\t%s\t%u\t%llu\t%llu\t%llu\t%llu\n");
+  std::vector<Value*> printArgs = {file, format,
+      dumpBuilder.CreateGlobalStringPtr(funcName),
+      dumpBuilder.CreateGlobalStringPtr(blockName),
+      dumpBuilder.CreateGlobalStringPtr(location),
+      dumpBuilder.CreateGlobalStringPtr(kind),
+      dumpBuilder.getInt32(vectorWidth)};
+  for (unsigned i = 0; i < 4; ++i) {
+    printArgs.push_back(dumpBuilder.CreateLoad(i64Ty, dumpBuilder.CreateConstInBoundsGEP2_32(counterTy, counters, 0, i)));
+  }
+  dumpBuilder.CreateCall(fprintfFunc, printArgs);
+}
+
+std::string
+GetBlockLocation(const BasicBlock & block) {
+  for (const auto & inst : block) {
+    const auto & loc = inst.getDebugLoc();
+    if (!loc) continue;
+
+    std::stringstream ss;
+    auto * scope = cast<DIScope>(loc.getScope());
+    ss << scope->getFilename().str() << ":" << loc.getLine() << ":" << loc.getCol();
+    return ss.str();
+  }
+  return "?";
+}
+
+}
@@ -0,0 +1,52 @@
+//===- src/native/LaneProfiler.h - lane occupancy instrumentation --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Counts executions and active lanes of predicated vector blocks (RV_PROFILE_LANES).
+// The counters are appended to a file at program exit (RV_LANE_PROFILE_FILE,
+// default "rv_lane_profile.txt"), one line per site:
+//
+//   <function> <block> <source location> <kind> <vector width> <executions> <active lanes> <no lane active> <all lanes active>
+//
+// The counters are not updated atomically.
+//
+
+#ifndef NATIVE_LANEPROFILER_H
+#define NATIVE_LANEPROFILER_H
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/IRBuilder.h>
+
+namespace llvm {
+  class Module;
+  class Function;
+  class BasicBlock;
+}
+
+namespace rv {
+
+class LaneProfiler {
+  llvm::Module & mod;
+
+  // the dump function (registered in llvm.global_dtors) and the block that prints all sites
+  llvm::BasicBlock & requestDumpBlock();
+
+public:
+  LaneProfiler(llvm::Module & _mod);
+
+  // count an execution of the site at the insertion point of @builder with @numActive lanes (integer) active.
+  void addSite(llvm::IRBuilder<> & builder, llvm::Value & numActive,
+               llvm::StringRef funcName, llvm::StringRef blockName,
+               llvm::StringRef location, llvm::StringRef kind, unsigned vectorWidth);
+};
+
+// the source location of @block (first debug location in the block, "?" if there is none)
+std::string GetBlockLocation(const llvm::BasicBlock & block);
+
+}
+
+#endif // NATIVE_LANEPROFILER_H
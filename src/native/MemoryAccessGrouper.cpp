@@ -99,6 +99,10 @@ const SCEV *MemoryAccessGrouper::add(Value *addrVal) {
 
     IF_DEBUG_MG errs() << "\tresult: " << offset << "\n";
 
+    // group members are indexed by lane elements
+    if (offset % (int64_t) laneByteSize != 0) continue;
+    offset /= (int64_t) laneByteSize;
+
     if (std::abs(offset) >= groupLimit) continue;
 
     IF_DEBUG_MG errs() << "== " << offset << "\n";
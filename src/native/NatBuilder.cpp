@@ -15,11 +15,17 @@
 #include <llvm/IR/Metadata.h>
 #include "llvm/IR/IntrinsicsX86.h"
 #include "llvm/Support/Alignment.h"
+#include "llvm/Analysis/Loads.h"
 #include "llvm/Transforms/Utils/LoopUtils.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
 #include <report.h>
 #include <fstream>
+#include <map>
+#include <mutex>
 
 #include "NatBuilder.h"
+#include "LaneProfiler.h"
 #include "Utils.h"
 
 #include "rv/transform/redTools.h"
@@ -27,6 +33,7 @@
 #include "rv/region/Region.h"
 #include "rv/rvDebug.h"
 #include "rv/intrinsics.h"
+#include "rv/annotations.h"
 
 #include "rvConfig.h"
 #include "ShuffleBuilder.h"
@@ -58,17 +65,9 @@ CreateScalarBroadcast(IRBuilder<> & builder, Value & scaValue, int elemCount) {
 
 namespace rv {
 
-unsigned numMaskedGather, numMaskedScatter, numGather, numScatter,
-    numInterMaskedLoads, numInterMaskedStores, numInterLoads, numInterStores,
-    numContMaskedLoads, numContMaskedStores, numContLoads, numContStores, numUniMaskedLoads, numUniMaskedStores,
-    numUniLoads, numUniStores, numUniAllocas, numSlowAllocas;
-
-unsigned numVecGEPs, numScalGEPs, numInterGEPs, numVecBCs, numScalBCs;
-unsigned numVecCalls, numSemiCalls, numFallCalls, numCascadeCalls, numRVIntrinsics;
-unsigned numScalarized, numVectorized, numFallbacked, numLazy;
-
-unsigned numConstLoadMasks, numUniLoadMasks, numVarLoadMasks;
-unsigned numConstStoreMasks, numUniStoreMasks, numVarStoreMasks;
+// NAT_STAT_DUMP totals over all regions (NatBuilders may run on several threads)
+static std::mutex csvTotalsMutex;
+static std::map<std::string, unsigned> csvTotals;
 
 bool DumpStatistics(std::string &file) {
   char * envVal = getenv("NAT_STAT_DUMP");
@@ -76,6 +75,12 @@ bool DumpStatistics(std::string &file) {
   else return !(file = envVal).empty();
 }
 
+bool DumpRegionRecords(std::string &file) {
+  char * envVal = getenv("NAT_STAT_JSON");
+  if (!envVal) return false;
+  else return !(file = envVal).empty();
+}
+
 Value*
 NatBuilder::getSplat(Constant* Elt) {
   auto EC = ElementCount::getFixed(vectorWidth());
@@ -129,51 +134,161 @@ void NatBuilder::printStatistics() {
   if (!DumpStatistics(fileName))
     return;
 
+  // accumulate the counters of this region
+  std::vector<std::pair<std::string, unsigned>> csvStats = {
+    // memory statistics
+    {(config.useScatterGatherIntrinsics ? "masked-scatter" : "masked-casc-store"), numMaskedScatter},
+    {(config.useScatterGatherIntrinsics ? "masked-gather" : "masked-casc-load"), numMaskedGather},
+    {(config.useScatterGatherIntrinsics ? "scatter" : "cascade-store"), numScatter},
+    {(config.useScatterGatherIntrinsics ? "gather" : "cascade-load"), numGather},
+    {"interleaved-masked-load", numInterMaskedLoads},
+    {"interleaved-masked-store", numInterMaskedStores},
+    {"interleaved-load", numInterLoads},
+    {"interleaved-store", numInterStores},
+    {"contiguous-masked-load", numContMaskedLoads},
+    {"contiguous-masked-store", numContMaskedStores},
+    {"contiguous-load", numContLoads},
+    {"contiguous-store", numContStores},
+    {"uniform-masked-load", numUniMaskedLoads},
+    {"uniform-masked-store", numUniMaskedStores},
+    {"uniform-load", numUniLoads},
+    {"uniform-store", numUniStores},
+    // lazy statistics
+    {"vector-GEP", numVecGEPs},
+    {"scalar-GEP", numScalGEPs},
+    {"interleaved-GEP", numInterGEPs},
+    {"vector-BC", numVecBCs},
+    {"scalar-BC", numScalBCs},
+    // call statistics
+    {"vec-call", numVecCalls},
+    {"semi-vec-call", numSemiCalls},
+    {"replicated-call", numFallCalls},
+    {"cascaded-call", numCascadeCalls},
+    {"rv-intrinsic", numRVIntrinsics},
+    // general statistics
+    {"scalarized", numScalarized},
+    {"vectorized", numVectorized},
+    {"replicated", numFallbacked},
+    {"lazy-instr", numLazy}
+  };
+
+  std::lock_guard<std::mutex> guard(csvTotalsMutex);
+  uint64_t fileSize = 0;
+  bool isNewFile = sys::fs::file_size(fileName, fileSize) || fileSize == 0;
+
   std::ofstream file;
   file.open(fileName, std::fstream::app);
 
   // header
-  file << "Feature,Frequency\n";
+  if (isNewFile) file << "Feature,Frequency\n";
 
-  // memory statistics
-  file << (config.useScatterGatherIntrinsics ? "masked-scatter," : "masked-casc-store,") << numMaskedScatter << "\n";
-  file << (config.useScatterGatherIntrinsics ? "masked-gather," : "masked-casc-load,") << numMaskedGather << "\n";
-  file << (config.useScatterGatherIntrinsics ? "scatter," : "cascade-store,") << numScatter << "\n";
-  file << (config.useScatterGatherIntrinsics ? "gather," : "cascade-load,")  << numGather << "\n";
-  file << "interleaved-masked-load," << numInterMaskedLoads << "\n";
-  file << "interleaved-masked-store," << numInterMaskedStores << "\n";
-  file << "interleaved-load," << numInterLoads << "\n";
-  file << "interleaved-store," << numInterStores << "\n";
-  file << "contiguous-masked-load," << numContMaskedLoads << "\n";
-  file << "contiguous-masked-store," << numContMaskedStores << "\n";
-  file << "contiguous-load," << numContLoads << "\n";
-  file << "contiguous-store," << numContStores << "\n";
-  file << "uniform-masked-load," << numUniMaskedLoads << "\n";
-  file << "uniform-masked-store," << numUniMaskedStores << "\n";
-  file << "uniform-load," << numUniLoads << "\n";
-  file << "uniform-store," << numUniStores << "\n";
+  for (auto & stat : csvStats) {
+    unsigned & total = csvTotals[stat.first];
+    total += stat.second;
+    file << stat.first << "," << total << "\n";
+  }
 
-  // lazy statistics
-  file << "vector-GEP," << numVecGEPs << "\n";
-  file << "scalar-GEP," << numScalGEPs << "\n";
-  file << "interleaved-GEP," << numInterGEPs << "\n";
-  file << "vector-BC," << numVecBCs << "\n";
-  file << "scalar-BC," << numScalBCs << "\n";
+  file.close();
+}
 
-  // call statistics
-  file << "vec-call," << numVecCalls << "\n";
-  file << "semi-vec-call," << numSemiCalls << "\n";
-  file << "replicated-call," << numFallCalls << "\n";
-  file << "cascaded-call," << numCascadeCalls << "\n";
-  file << "rv-intrinsic," << numRVIntrinsics << "\n";
+NatBuilder::StatisticVec
+NatBuilder::getStatistics() const {
+  return {
+    {"Gathers", numGather}, {"MaskedGathers", numMaskedGather},
+    {"Scatters", numScatter}, {"MaskedScatters", numMaskedScatter},
+    {"InterleavedLoads", numInterLoads}, {"MaskedInterleavedLoads", numInterMaskedLoads},
+    {"InterleavedStores", numInterStores}, {"MaskedInterleavedStores", numInterMaskedStores},
+    {"ContiguousLoads", numContLoads}, {"MaskedContiguousLoads", numContMaskedLoads},
+    {"ContiguousStores", numContStores}, {"MaskedContiguousStores", numContMaskedStores},
+    {"UniformLoads", numUniLoads}, {"MaskedUniformLoads", numUniMaskedLoads},
+    {"UniformStores", numUniStores}, {"MaskedUniformStores", numUniMaskedStores},
+    {"VectorCalls", numVecCalls}, {"ReplicatedCalls", numFallCalls}, {"CascadedCalls", numCascadeCalls},
+    {"ReplicatedInsts", numFallbacked}
+  };
+}
 
-  // general statistics
-  file << "scalarized," << numScalarized << "\n";
-  file << "vectorized," << numVectorized << "\n";
-  file << "replicated," << numFallbacked << "\n";
-  file << "lazy-instr," << numLazy << "\n";
+void
+NatBuilder::emitStatisticsRemark() {
+  ORE.emit([&]() {
+    auto * regionTerm = vecInfo.getEntry().getTerminator();
+    OptimizationRemarkAnalysis remark("rv-native", "CodeGen", regionTerm);
+    remark << "vector code with width " << ore::NV("VectorWidth", vectorWidth());
+
+    for (auto & stat : getStatistics()) {
+      if (stat.second == 0) continue;
+      remark << ", " << ore::NV(stat.first, stat.second);
+    }
+    return remark;
+  });
+}
 
-  file.close();
+NatBuilder::StatisticVec
+NatBuilder::getShapeStatistics() const {
+  unsigned numUniform = 0, numContiguous = 0, numStrided = 0, numVarying = 0;
+  vecInfo.getRegion().for_blocks([&](const BasicBlock & block) {
+    for (auto & inst : block) {
+      if (!vecInfo.hasKnownShape(inst)) continue;
+      auto shape = vecInfo.getVectorShape(inst);
+      if (shape.isUniform()) ++numUniform;
+      else if (shape.isContiguous()) ++numContiguous;
+      else if (shape.hasStridedShape()) ++numStrided;
+      else ++numVarying;
+    }
+    return true;
+  });
+  return {{"uniform", numUniform}, {"contiguous", numContiguous}, {"strided", numStrided}, {"varying", numVarying}};
+}
+
+// one JSON object per line and region, e.g.
+// {"function":"foo","location":"foo.c:12:3","loop":true,"width":8,"shapes":{..},"codegen":{..},"linearizer":{..}}
+void
+NatBuilder::dumpRegionRecord(const StatisticVec & shapeStats) {
+  std::string fileName;
+  if (!DumpRegionRecords(fileName))
+    return;
+
+  // source location of the region (loop header or function entry)
+  std::string location;
+  for (auto & inst : vecInfo.getEntry()) {
+    const DebugLoc & dbgLoc = inst.getDebugLoc();
+    if (!dbgLoc) continue;
+    location = (dbgLoc->getFilename() + ":" + Twine(dbgLoc.getLine()) + ":" + Twine(dbgLoc.getCol())).str();
+    break;
+  }
+  if (location.empty()) location = vecInfo.getEntry().getName().str();
+
+  std::string record;
+  raw_string_ostream recordOut(record);
+  json::OStream J(recordOut);
+  J.object([&] {
+    J.attribute("function", vecInfo.getScalarFunction().getName());
+    J.attribute("vector-function", vecInfo.getVectorFunction().getName());
+    J.attribute("location", location);
+    J.attribute("loop", vecInfo.getRegion().isVectorLoop());
+    J.attribute("width", (int64_t) vectorWidth());
+    J.attribute("gather-lowering", config.useScatterGatherIntrinsics ? "intrinsic" : "cascade");
+    J.attributeObject("shapes", [&] {
+      for (auto & stat : shapeStats) J.attribute(stat.first, (int64_t) stat.second);
+    });
+    J.attributeObject("codegen", [&] {
+      for (auto & stat : getStatistics()) J.attribute(stat.first, (int64_t) stat.second);
+    });
+    J.attributeObject("linearizer", [&] {
+      for (auto & stat : vecInfo.getRegionStatistics()) J.attribute(stat.first, (int64_t) stat.second);
+    });
+  });
+  recordOut << "\n";
+  recordOut.flush();
+
+  // a single append per record keeps the file intact when several compiler processes share it
+  std::error_code EC;
+  raw_fd_ostream file(fileName, EC, sys::fs::OF_Append);
+  if (EC) {
+    Report() << "could not open NAT_STAT_JSON file " << fileName << ": " << EC.message() << "\n";
+    return;
+  }
+  file.SetUnbuffered();
+  file << record;
 }
 
 VectorShape NatBuilder::getVectorShape(const Value &val) {
@@ -190,6 +305,7 @@ NatBuilder::NatBuilder(Config _config, PlatformInfo &_platInfo, VectorizationInf
     dominatorTree(FAM.getResult<DominatorTreeAnalysis>(vecInfo.getScalarFunction())),
     memDepRes(FAM.getResult<MemoryDependenceAnalysis>(vecInfo.getScalarFunction())),
     SE(FAM.getResult<ScalarEvolutionAnalysis>(vecInfo.getScalarFunction())),
+    ORE(FAM.getResult<OptimizationRemarkEmitterAnalysis>(vecInfo.getScalarFunction())),
     reda(_reda),
     undeadMasks(vecInfo, FAM),
     layout(_vecInfo.getScalarFunction().getParent()),
@@ -197,8 +313,6 @@ NatBuilder::NatBuilder(Config _config, PlatformInfo &_platInfo, VectorizationInf
     i32Ty(IntegerType::get(_vecInfo.getMapping().vectorFn->getContext(), 32)),
     vecMaskArg(nullptr),
     keepScalar(),
-    cascadeLoadMap(),
-    cascadeStoreMap(),
     vectorValueMap(),
     scalarValueMap(),
     basicBlockMap(),
@@ -209,6 +323,7 @@ NatBuilder::NatBuilder(Config _config, PlatformInfo &_platInfo, VectorizationInf
 void NatBuilder::vectorize(bool embedRegion, ValueToValueMapTy * vecInstMap) {
   const Function *func = vecInfo.getMapping().scalarFn;
   Function *vecFunc = vecInfo.getMapping().vectorFn;
+  auto shapeStats = getShapeStatistics();
 
   IF_DEBUG_NAT {
     errs() << "-- status before vector codegen --\n";
@@ -287,6 +402,8 @@ void NatBuilder::vectorize(bool embedRegion, ValueToValueMapTy * vecInstMap) {
 
   // report statistics
   printStatistics();
+  emitStatisticsRemark();
+  dumpRegionRecord(shapeStats);
 
   if (!vecInfo.getRegion().isVectorLoop()) return;
 
@@ -364,6 +481,9 @@ void NatBuilder::vectorize(BasicBlock *const bb, BasicBlock *vecBlock) {
       if (!lazyInstructions.empty())
         requestLazyInstructions(lazyInstructions.back());
       assert(lazyInstructions.empty() && "not all lazy instructions vectorized!!");
+
+      if (config.enableLaneProfiling && !hasUniformPredicate(*bb))
+        instrumentLaneOccupancy(*bb);
     }
 
     PHINode *phi = dyn_cast<PHINode>(inst);
@@ -402,7 +522,10 @@ void NatBuilder::vectorize(BasicBlock *const bb, BasicBlock *vecBlock) {
     }
 
     // loads and stores need special treatment (masking, shuffling, etc) (build them lazily)
-    if (canVectorize(inst) && (load || store))
+    auto * compactIdx = store ? getCompactIndex(*store) : nullptr;
+    if (compactIdx)
+      vectorizeCompactStore(*store, *compactIdx);
+    else if (canVectorize(inst) && (load || store))
       if (config.enableInterleaved) addLazyInstruction(inst);
       else vectorizeMemoryInstruction(inst);
     else if (store) {
@@ -816,6 +939,143 @@ void NatBuilder::vectorizeAlloca(AllocaInst *const allocaInst) {
   replicateInstruction(allocaInst);
 }
 
+// the reduction that combines the operands of @op (Top if they can not be combined)
+static RedKind
+GetAtomicRedKind(AtomicRMWInst::BinOp op) {
+  switch (op) {
+    case AtomicRMWInst::Add:
+    case AtomicRMWInst::Sub:  return RedKind::Add;
+    case AtomicRMWInst::And:  return RedKind::And;
+    case AtomicRMWInst::Or:   return RedKind::Or;
+    case AtomicRMWInst::Xor:  return RedKind::Xor;
+    case AtomicRMWInst::Max:  return RedKind::SMax;
+    case AtomicRMWInst::Min:  return RedKind::SMin;
+    case AtomicRMWInst::UMax: return RedKind::UMax;
+    case AtomicRMWInst::UMin: return RedKind::UMin;
+    default:                  return RedKind::Top;
+  }
+}
+
+Value*
+NatBuilder::createCombinedAtomicRMW(AtomicRMWInst & atomicrmw, RedKind redKind, Value & ptr, Value & vecVal, Value & mask) {
+  auto * vecTy = cast<FixedVectorType>(vecVal.getType());
+  auto * neutralVec = getSplat(&GetNeutralElement(redKind, *vecTy->getElementType()));
+
+// combine the operands of all lanes in @mask into a single atomic
+  auto * maskedVal = builder.CreateSelect(&mask, &vecVal, neutralVec, atomicrmw.getName() + ".opnds");
+  auto & combinedVal = CreateVectorReduce(config, builder, redKind, *maskedVal, nullptr);
+
+  auto * clonedInst = cast<AtomicRMWInst>(atomicrmw.clone());
+  clonedInst->setOperand(0, &ptr);
+  clonedInst->setOperand(1, &combinedVal);
+  builder.Insert(clonedInst, atomicrmw.getName());
+
+  if (atomicrmw.use_empty()) return nullptr;
+
+// each lane observes the value after all preceding lanes of @mask
+  std::vector<Constant*> shiftElems;
+  shiftElems.push_back(ConstantInt::get(i32Ty, 0));
+  for (int i = 1; i < vectorWidth(); ++i) {
+    shiftElems.push_back(ConstantInt::get(i32Ty, vectorWidth() + i - 1));
+  }
+  auto & inclusive = CreateVectorScan(builder, redKind, *maskedVal);
+  auto * exclusive = builder.CreateShuffleVector(neutralVec, &inclusive, ConstantVector::get(shiftElems), atomicrmw.getName() + ".excl");
+
+  auto * oldVec = builder.CreateVectorSplat(vectorWidth(), clonedInst);
+  if (atomicrmw.getOperation() == AtomicRMWInst::Sub) {
+    return builder.CreateSub(oldVec, exclusive, atomicrmw.getName());
+  }
+  return &CreateReductInst(builder, redKind, *oldVec, *exclusive);
+}
+
+void
+NatBuilder::vectorizeMaskedAtomicRMW(AtomicRMWInst & atomicrmw, RedKind redKind) {
+  auto & context = atomicrmw.getContext();
+  auto * vecFunc = builder.GetInsertBlock()->getParent();
+
+  auto * ptr = requestScalarValue(atomicrmw.getPointerOperand());
+  auto * vecVal = requestVectorValue(atomicrmw.getValOperand());
+  auto * mask = requestVectorPredicate(*atomicrmw.getParent());
+
+// skip the atomic if no lane is active
+  auto * entryBlock = builder.GetInsertBlock();
+  auto * atomicBlock = BasicBlock::Create(context, "atomic.masked", vecFunc);
+  auto * endBlock = BasicBlock::Create(context, "atomic.end", vecFunc);
+  auto & anyActive = CreateVectorReduce(config, builder, RedKind::Or, *mask, nullptr);
+  builder.CreateCondBr(&anyActive, atomicBlock, endBlock);
+
+  builder.SetInsertPoint(atomicBlock);
+  auto * laneResults = createCombinedAtomicRMW(atomicrmw, redKind, *ptr, *vecVal, *mask);
+  builder.CreateBr(endBlock);
+
+  builder.SetInsertPoint(endBlock);
+  if (laneResults) {
+    auto * resultPhi = builder.CreatePHI(laneResults->getType(), 2, atomicrmw.getName());
+    resultPhi->addIncoming(UndefValue::get(laneResults->getType()), entryBlock);
+    resultPhi->addIncoming(laneResults, atomicBlock);
+    mapVectorValue(&atomicrmw, resultPhi);
+  }
+
+  // remap to tail block
+  mapVectorValue(atomicrmw.getParent(), endBlock);
+}
+
+void
+NatBuilder::vectorizeConflictingAtomicRMW(AtomicRMWInst & atomicrmw, RedKind redKind) {
+  auto & context = atomicrmw.getContext();
+  auto * vecFunc = builder.GetInsertBlock()->getParent();
+  auto * module = vecFunc->getParent();
+
+  auto * ptrVec = requestVectorValue(atomicrmw.getPointerOperand());
+  auto * vecVal = requestVectorValue(atomicrmw.getValOperand());
+  Value * predicate = vecInfo.getPredicate(*atomicrmw.getParent());
+  Value * mask = predicate ? requestVectorValue(predicate) : getConstantVector(vectorWidth(), i1Ty, 1);
+
+// serve the lanes grouped by address (the first pending lane leads its group)
+  auto * entryBlock = builder.GetInsertBlock();
+  auto * conflictBlock = BasicBlock::Create(context, "atomic.conflict", vecFunc);
+  auto * endBlock = BasicBlock::Create(context, "atomic.end", vecFunc);
+  auto & anyActive = CreateVectorReduce(config, builder, RedKind::Or, *mask, nullptr);
+  builder.CreateCondBr(&anyActive, conflictBlock, endBlock);
+
+  builder.SetInsertPoint(conflictBlock);
+  auto * pendingPhi = builder.CreatePHI(mask->getType(), 2, atomicrmw.getName() + ".pending");
+  pendingPhi->addIncoming(mask, entryBlock);
+  auto * vecResTy = vecVal->getType();
+  auto * resultPhi = atomicrmw.use_empty() ? nullptr : builder.CreatePHI(vecResTy, 2, atomicrmw.getName() + ".res");
+  if (resultPhi) resultPhi->addIncoming(UndefValue::get(vecResTy), entryBlock);
+
+  auto * pendingBits = createVectorMaskSummary(*i32Ty, pendingPhi, builder, RVIntrinsic::Ballot);
+  auto * cttzDecl = Intrinsic::getDeclaration(module, Intrinsic::cttz, {i32Ty});
+  auto * leaderLane = builder.CreateCall(cttzDecl, {pendingBits, builder.getTrue()}, "atomic.leader");
+  auto * leaderPtr = builder.CreateExtractElement(ptrVec, leaderLane, "atomic.ptr");
+  auto * samePtr = builder.CreateICmpEQ(ptrVec, builder.CreateVectorSplat(vectorWidth(), leaderPtr));
+  auto * groupMask = builder.CreateAnd(pendingPhi, samePtr, atomicrmw.getName() + ".group");
+
+  auto * laneResults = createCombinedAtomicRMW(atomicrmw, redKind, *leaderPtr, *vecVal, *groupMask);
+  Value * nextResults = nullptr;
+  if (resultPhi) {
+    nextResults = builder.CreateSelect(groupMask, laneResults, resultPhi);
+    resultPhi->addIncoming(nextResults, conflictBlock);
+  }
+
+  auto * nextPending = builder.CreateAnd(pendingPhi, builder.CreateNot(groupMask), atomicrmw.getName() + ".pending");
+  pendingPhi->addIncoming(nextPending, conflictBlock);
+  auto & anyPending = CreateVectorReduce(config, builder, RedKind::Or, *nextPending, nullptr);
+  builder.CreateCondBr(&anyPending, conflictBlock, endBlock);
+
+  builder.SetInsertPoint(endBlock);
+  if (resultPhi) {
+    auto * endPhi = builder.CreatePHI(vecResTy, 2, atomicrmw.getName());
+    endPhi->addIncoming(UndefValue::get(vecResTy), entryBlock);
+    endPhi->addIncoming(nextResults, conflictBlock);
+    mapVectorValue(&atomicrmw, endPhi);
+  }
+
+  // remap to tail block
+  mapVectorValue(atomicrmw.getParent(), endBlock);
+}
+
 void NatBuilder::vectorizeAtomicRMW(AtomicRMWInst *const atomicrmw) {
   VectorShape shape = getVectorShape(*atomicrmw);
   if (shape.isStrided() || shape.isContiguous()) {
@@ -843,16 +1103,21 @@ void NatBuilder::vectorizeAtomicRMW(AtomicRMWInst *const atomicrmw) {
     Value * ptr = atomicrmw->getPointerOperand();
     Value * val = atomicrmw->getValOperand();
     VectorShape ptrShape = getVectorShape(*ptr);
+    RedKind redKind = GetAtomicRedKind(atomicrmw->getOperation());
 
     if (!ptrShape.isUniform()) {
-      replicateInstruction(atomicrmw);
+      // one atomic per distinct address
+      if (redKind != RedKind::Top && vectorWidth() <= 32) vectorizeConflictingAtomicRMW(*atomicrmw, redKind);
+      else replicateInstruction(atomicrmw);
       return;
     }
     Value *predicate = vecInfo.getPredicate(*atomicrmw->getParent());
     assert(predicate && predicate->getType()->isIntegerTy(1) && "predicate must have i1 type!");
     bool needsMask = predicate && !vecInfo.getVectorShape(*predicate).isUniform();
     if (needsMask) {
-      replicateInstruction(atomicrmw);
+      // masked reduction and a single atomic (if any lane is active)
+      if (redKind != RedKind::Top) vectorizeMaskedAtomicRMW(*atomicrmw, redKind);
+      else replicateInstruction(atomicrmw);
       return;
     }
 
@@ -885,6 +1150,7 @@ void NatBuilder::vectorizeAtomicRMW(AtomicRMWInst *const atomicrmw) {
     case AtomicRMWInst::Sub:
     case AtomicRMWInst::And:
     case AtomicRMWInst::Or:
+    case AtomicRMWInst::Xor:
     case AtomicRMWInst::Max:
     case AtomicRMWInst::Min:
     case AtomicRMWInst::UMax:
@@ -894,21 +1160,7 @@ void NatBuilder::vectorizeAtomicRMW(AtomicRMWInst *const atomicrmw) {
 
       Value *vectorizedVal = requestVectorValue(val);
 
-      RedKind reduction = RedKind::Top;
-      switch (atomicrmw->getOperation()) {
-      case AtomicRMWInst::Add:
-      case AtomicRMWInst::Sub:  reduction = RedKind::Add; break;
-      case AtomicRMWInst::And:  reduction = RedKind::And; break;
-      case AtomicRMWInst::Or:   reduction = RedKind::Or; break;
-      case AtomicRMWInst::Max:  reduction = RedKind::SMax; break;
-      case AtomicRMWInst::Min:  reduction = RedKind::SMin; break;
-      case AtomicRMWInst::UMax: reduction = RedKind::UMax; break;
-      case AtomicRMWInst::UMin: reduction = RedKind::UMin; break;
-      default:
-        llvm_unreachable("case missing");
-      }
-
-      Value *finalVal = &CreateVectorReduce(config, builder, reduction, *vectorizedVal, nullptr);
+      Value *finalVal = &CreateVectorReduce(config, builder, redKind, *vectorizedVal, nullptr);
 
       clonedInst->setOperand(1, finalVal);
       builder.Insert(clonedInst);
@@ -923,6 +1175,7 @@ void NatBuilder::vectorizeAtomicRMW(AtomicRMWInst *const atomicrmw) {
         case AtomicRMWInst::Sub:  itervar = builder.CreateSub(itervar, update); break;
         case AtomicRMWInst::And:  itervar = builder.CreateAnd(itervar, update); break;
         case AtomicRMWInst::Or:   itervar = builder.CreateOr(itervar, update); break;
+        case AtomicRMWInst::Xor:  itervar = builder.CreateXor(itervar, update); break;
         case AtomicRMWInst::Max:  itervar = createMinMaxOp(builder, RecurKind::SMax, itervar, update); break;
         case AtomicRMWInst::UMax: itervar = createMinMaxOp(builder, RecurKind::UMax, itervar, update); break;
         case AtomicRMWInst::Min:  itervar = createMinMaxOp(builder, RecurKind::SMin, itervar, update); break;
@@ -1183,6 +1436,13 @@ NatBuilder::createVectorMaskSummary(Type & indexTy, Value * vecVal, IRBuilder<>
   Value * result = nullptr;
   switch (mode) {
     case RVIntrinsic::Ballot: {
+      // AVX-512: the mask is a k-register (kmov)
+      if (config.useAVX512 && vecWidth <= 64) {
+        auto * maskBits = builder.CreateBitCast(vecVal, builder.getIntNTy(vecWidth), "rv_ballot");
+        result = builder.CreateZExtOrTrunc(maskBits, &indexTy, "rv_ballot");
+        break;
+      }
+
       // If SSE is available, but AVX and above are not, and the vector width is greater than 4, split the vector
       bool shouldSplitForISA = vecWidth > 4 && config.useSSE && !config.useAVX && !config.useAVX2 && !config.useAVX512;
       if (vecWidth > 8 || shouldSplitForISA) {
@@ -1249,7 +1509,7 @@ NatBuilder::createVectorMaskSummary(Type & indexTy, Value * vecVal, IRBuilder<>
     case RVIntrinsic::PopCount: {
       if (config.useAVX || config.useAVX2) {
         // ISPC popcount pattern
-        auto maskIntTy = builder.getIntNTy(vectorWidth());
+        auto maskIntTy = builder.getIntNTy(vecWidth);
         auto maskBitCast = builder.CreateBitCast(vecVal, maskIntTy);
         auto maskZExt = builder.CreateZExt(maskBitCast, &indexTy);
         auto ctPopFunc = Intrinsic::getDeclaration(mod, Intrinsic::ctpop, &indexTy); // FIXME use a larger type (what should happen for <4096 x i8>)??
@@ -1267,6 +1527,22 @@ NatBuilder::createVectorMaskSummary(Type & indexTy, Value * vecVal, IRBuilder<>
   return result;
 }
 
+void
+NatBuilder::instrumentLaneOccupancy(BasicBlock & scaBlock) {
+  auto & vecFunc = *vecInfo.getMapping().vectorFn;
+  auto * i64Ty = builder.getInt64Ty();
+  auto * numActive = createVectorMaskSummary(*i64Ty, requestVectorPredicate(scaBlock), builder, RVIntrinsic::PopCount);
+
+  // headers of (divergent) loops are reached through a back edge
+  bool isLoopHeader = std::any_of(pred_begin(&scaBlock), pred_end(&scaBlock), [&](const BasicBlock * predBlock) {
+    return dominatorTree.dominates(&scaBlock, predBlock);
+  });
+
+  LaneProfiler profiler(*vecFunc.getParent());
+  profiler.addSite(builder, *numActive, vecFunc.getName(), scaBlock.getName(),
+                   GetBlockLocation(scaBlock), isLoopHeader ? "loop" : "block", vectorWidth());
+}
+
 void
 NatBuilder::vectorizeBallotCall(CallInst *rvCall) {
   ++numRVIntrinsics;
@@ -1413,17 +1689,150 @@ NatBuilder::vectorizeCompactCall(CallInst *rvCall) {
   auto * vecVal  = requestVectorValue(vecArg);
   auto * maskVal = requestVectorValue(maskArg);
 
-  auto vecWidth = cast<FixedVectorType>(maskVal->getType())->getNumElements();
-  auto tableIndex = createVectorMaskSummary(*rvCall->getType(), maskVal, builder, RVIntrinsic::Ballot);
+  mapVectorValue(rvCall, createCompact(*vecVal, *maskVal));
+}
+
+Value*
+NatBuilder::createCompact(Value & vecVal, Value & maskVal) {
+  auto & vecTy = *cast<FixedVectorType>(vecVal.getType());
+  auto * elemTy = vecTy.getElementType();
+  unsigned vecWidth = vecTy.getNumElements();
+  unsigned elemBits = elemTy->getScalarSizeInBits();
+  bool isPrimitiveElem = elemTy->isIntegerTy() || elemTy->isFloatingPointTy();
+  auto * module = vecInfo.getVectorFunction().getParent();
+
+// native compress (AVX-512 vcompressps/pd, vpcompressd/q)
+  unsigned vecBits = vecWidth * elemBits;
+  bool hasNativeCompress = config.useAVX512 && isPrimitiveElem && (elemBits == 32 || elemBits == 64) &&
+                           (vecBits == 128 || vecBits == 256 || vecBits == 512);
+  if (hasNativeCompress) {
+    // inactive upper lanes keep their original value (same as the lookup table)
+    auto * compressDecl = Intrinsic::getDeclaration(module, Intrinsic::x86_avx512_mask_compress, {&vecTy});
+    return builder.CreateCall(compressDecl, {&vecVal, &vecVal, &maskVal}, "rv_compact");
+  }
+
+// split-and-merge for wide vectors
+  if (vecWidth > 8) {
+    assert(vecWidth % 2 == 0 && "can not split odd vector width for rv_compact");
+    unsigned halfWidth = vecWidth / 2;
+    SmallVector<int, 16> lowLanes, highLanes;
+    for (unsigned i = 0; i < halfWidth; ++i) {
+      lowLanes.push_back(i);
+      highLanes.push_back(halfWidth + i);
+    }
+    auto * lowMask = builder.CreateShuffleVector(&maskVal, lowLanes, "rv_compact_mask.lo");
+    auto * highMask = builder.CreateShuffleVector(&maskVal, highLanes, "rv_compact_mask.hi");
+    auto * lowCompact = createCompact(*builder.CreateShuffleVector(&vecVal, lowLanes, "rv_compact_vec.lo"), *lowMask);
+    auto * highCompact = createCompact(*builder.CreateShuffleVector(&vecVal, highLanes, "rv_compact_vec.hi"), *highMask);
+    auto * numLow = createVectorMaskSummary(*builder.getInt32Ty(), lowMask, builder, RVIntrinsic::PopCount);
+    auto * numHigh = createVectorMaskSummary(*builder.getInt32Ty(), highMask, builder, RVIntrinsic::PopCount);
+
+    // merge through a stack slot: the high half starts right after the active lanes of the low half
+    auto & entryBlock = vecInfo.getVectorFunction().getEntryBlock();
+    IRBuilder<> allocaBuilder(&entryBlock, entryBlock.getFirstInsertionPt());
+    auto * mergeSlot = allocaBuilder.CreateAlloca(&vecTy, nullptr, "rv_compact_slot");
+    auto elemAlign = module->getDataLayout().getABITypeAlign(elemTy);
+    auto * halfPtrTy = FixedVectorType::get(elemTy, halfWidth)->getPointerTo();
+
+    auto * elemPtr = builder.CreatePointerCast(mergeSlot, elemTy->getPointerTo());
+    builder.CreateAlignedStore(lowCompact, builder.CreatePointerCast(elemPtr, halfPtrTy), elemAlign);
+    auto * highPtr = builder.CreateInBoundsGEP(elemTy, elemPtr, numLow, "rv_compact_slot.hi");
+    builder.CreateAlignedStore(highCompact, builder.CreatePointerCast(highPtr, halfPtrTy), elemAlign);
+    auto * merged = builder.CreateAlignedLoad(&vecTy, mergeSlot, elemAlign, "rv_compact_merged");
+
+    // lanes past the active ones keep their original value (the slot holds the tail of the high half there)
+    auto * numActive = builder.CreateAdd(numLow, numHigh, "rv_compact_num");
+    auto * laneIds = createContiguousVector(vecWidth, builder.getInt32Ty(), 0, 1);
+    auto * isTail = builder.CreateICmpUGE(laneIds, builder.CreateVectorSplat(vecWidth, numActive), "rv_compact_tail");
+    return builder.CreateSelect(isTail, &vecVal, merged, "rv_compact");
+  }
+
+// table lookup of the lane permutation
+  auto tableIndex = createVectorMaskSummary(*builder.getInt32Ty(), &maskVal, builder, RVIntrinsic::Ballot);
   auto table = createCompactLookupTable(vecWidth);
-  auto indices = builder.CreateLoad(builder.CreateInBoundsGEP(table, { builder.getInt32(0), tableIndex }), "rv_compact_indices");
-  Value * compacted = UndefValue::get(vecVal->getType());
+  auto * indexVecTy = FixedVectorType::get(builder.getInt32Ty(), vecWidth);
+  auto indices = builder.CreateLoad(indexVecTy, builder.CreateInBoundsGEP(table, { builder.getInt32(0), tableIndex }), "rv_compact_indices");
+
+  // single variable permutation (AVX2 vpermps)
+  if ((config.useAVX2 || config.useAVX512) && isPrimitiveElem && vecWidth == 8 && elemBits == 32) {
+    auto * permTy = FixedVectorType::get(builder.getFloatTy(), vecWidth);
+    auto * permDecl = Intrinsic::getDeclaration(module, Intrinsic::x86_avx2_permps);
+    Value * permArgs[] = {builder.CreateBitCast(&vecVal, permTy), indices};
+    auto * permVal = builder.CreateCall(permDecl, permArgs, "rv_compact_perm");
+    return builder.CreateBitCast(permVal, &vecTy, "rv_compact");
+  }
+
+  Value * compacted = UndefValue::get(&vecTy);
   for (size_t i = 0; i < vecWidth; ++i) {
     auto index = builder.CreateExtractElement(indices, builder.getInt32(i), "rv_compact_index");
-    auto elem = builder.CreateExtractElement(vecVal, index, "rv_compact_elem");
+    auto elem = builder.CreateExtractElement(&vecVal, index, "rv_compact_elem");
     compacted = builder.CreateInsertElement(compacted, elem, builder.getInt32(i), "rv_compact");
   }
-  mapVectorValue(rvCall, compacted);
+  return compacted;
+}
+
+PHINode*
+NatBuilder::getCompactIndex(StoreInst & store) {
+  auto * gep = dyn_cast<GetElementPtrInst>(store.getPointerOperand());
+  if (!gep || gep->getNumIndices() != 1) return nullptr;
+
+  Value * idxVal = gep->getOperand(1);
+  if (isa<SExtInst>(idxVal) || isa<ZExtInst>(idxVal)) idxVal = cast<Instruction>(idxVal)->getOperand(0);
+  auto * idxPhi = dyn_cast<PHINode>(idxVal);
+  if (!idxPhi || idxPhi->getParent() != &vecInfo.getEntry()) return nullptr;
+
+  auto * red = reda.getReductionInfo(*idxPhi);
+  return (red && red->isCompact) ? idxPhi : nullptr;
+}
+
+PHINode&
+NatBuilder::requestCompactBase(PHINode & scaIdxPhi) {
+  auto itBase = compactBaseMap.find(&scaIdxPhi);
+  if (itBase != compactBaseMap.end()) return *itBase->second;
+
+  // incoming values are attached in materializeCompactIndex
+  auto * vecHeader = getVectorBlock(*scaIdxPhi.getParent(), false);
+  auto * basePhi = PHINode::Create(scaIdxPhi.getType(), 2, scaIdxPhi.getName() + ".base", &*vecHeader->begin());
+  compactBaseMap[&scaIdxPhi] = basePhi;
+  return *basePhi;
+}
+
+void
+NatBuilder::vectorizeCompactStore(StoreInst & store, PHINode & scaIdxPhi) {
+  auto * gep = cast<GetElementPtrInst>(store.getPointerOperand());
+  auto * module = vecInfo.getVectorFunction().getParent();
+
+// the first active lane stores at the running index
+  Value * baseIdx = &requestCompactBase(scaIdxPhi);
+  if (auto * idxCast = dyn_cast<CastInst>(gep->getOperand(1))) {
+    baseIdx = builder.CreateCast(idxCast->getOpcode(), baseIdx, idxCast->getDestTy());
+  }
+  auto * basePtr = requestScalarValue(gep->getPointerOperand());
+  auto * ptr = gep->isInBounds() ? builder.CreateInBoundsGEP(gep->getSourceElementType(), basePtr, baseIdx, "compact.ptr")
+                                 : builder.CreateGEP(gep->getSourceElementType(), basePtr, baseIdx, "compact.ptr");
+
+  Value * predicate = vecInfo.getPredicate(*store.getParent());
+  Value * mask = predicate ? requestVectorValue(predicate) : getConstantVector(vectorWidth(), i1Ty, 1);
+  auto * vecVal = requestVectorValue(store.getValueOperand());
+  auto * vecTy = cast<FixedVectorType>(vecVal->getType());
+
+// AVX-512 vcompress to memory
+  Value * vecMem;
+  if (config.useAVX512) {
+    auto * compressDecl = Intrinsic::getDeclaration(module, Intrinsic::masked_compressstore, {vecTy});
+    Value * compressArgs[] = {vecVal, ptr, mask};
+    vecMem = builder.CreateCall(compressDecl, compressArgs);
+
+  } else {
+    // compact in register, store the leading popcount(mask) lanes
+    auto * compacted = createCompact(*vecVal, *mask);
+    auto * numActive = createVectorMaskSummary(*i32Ty, mask, builder, RVIntrinsic::PopCount);
+    auto * laneIds = createContiguousVector(vectorWidth(), i32Ty, 0, 1);
+    auto * storeMask = builder.CreateICmpULT(laneIds, builder.CreateVectorSplat(vectorWidth(), numActive), "compact.mask");
+    auto * vecPtr = builder.CreatePointerCast(ptr, vecTy->getPointerTo(gep->getPointerAddressSpace()));
+    vecMem = builder.CreateMaskedStore(compacted, vecPtr, store.getAlign(), storeMask);
+  }
+  mapVectorValue(&store, vecMem);
 }
 
 Constant*
@@ -1503,6 +1912,9 @@ NatBuilder::vectorizeCallInstruction(CallInst *const scalCall) {
       case Intrinsic::lifetime_start:
       case Intrinsic::lifetime_end:
         Report() << "nat: dropped divergent lifetime marker!\n";
+        ORE.emit([&]() {
+          return OptimizationRemarkMissed("rv-native", "DivergentLifetimeMarker", scalCall) << "dropped divergent lifetime marker";
+        });
         return;
     }
   }
@@ -1757,18 +2169,22 @@ void NatBuilder::vectorizeMemoryInstruction(Instruction *const inst) {
     auto & ptrTy = *cast<PointerType>(ptr->getType());
     PointerType *vecPtrType = vecType->getPointerTo(ptrTy.getAddressSpace());
     addr.push_back(builder.CreatePointerCast(ptr, vecPtrType, "vec_cast"));
-    alignment = llvm::Align(addrShape.getAlignmentFirst());
+    // the loop vectorizer may have peeled iterations to align this access
+    alignment = llvm::Align(std::max<unsigned>(addrShape.getAlignmentFirst(), ReadAlignmentHint(*inst)));
 
   } else if ((addrShape.isStrided() && isInterleaved(inst, accessedPtr, byteSize, srcs)) && !(needsMask && !config.enableMaskedMove)) {
     // interleaved access. ptrs: base, base+vector, base+2vector, ...
-    Value *srcPtr = getPointerOperand(cast<Instruction>(srcs[0]));
+    auto *srcInst = cast<Instruction>(srcs[0]);
+    Value *srcPtr = getPointerOperand(srcInst);
     for (unsigned i = 0; i < srcs.size(); ++i) {
       Value *ptr = requestInterleavedAddress(srcPtr, i, vecType);
       addr.push_back(ptr);
       if (needsMask)
         masks.push_back(mask);
     }
-    alignment = llvm::Align(addrShape.getAlignmentFirst());
+    // all parts are accessed relative to the first member
+    llvm::Align srcAlignment = std::max<llvm::Align>(llvm::Align(getVectorShape(*srcPtr).getAlignmentFirst()), getLoadStoreAlignment(srcInst));
+    alignment = commonAlignment(srcAlignment, vectorWidth() * byteSize);
     interleaved = true;
 
   } else {
@@ -1776,8 +2192,10 @@ void NatBuilder::vectorizeMemoryInstruction(Instruction *const inst) {
     alignment = llvm::Align(addrShape.getAlignmentGeneral());
   }
 
+  // (the alignment of @inst does not apply to the other interleaved members)
   llvm::Align origAlignment = load ? load->getAlign() : store->getAlign();
-  alignment = std::max<llvm::Align>(alignment, origAlignment);
+  if (!interleaved)
+    alignment = std::max<llvm::Align>(alignment, origAlignment);
 
   Value *vecMem = nullptr;
   if (load) {
@@ -1797,7 +2215,7 @@ void NatBuilder::vectorizeMemoryInstruction(Instruction *const inst) {
 
     } else {
       assert(addr.size() == 1 && "multiple addresses for single access!");
-      vecMem = createVaryingMemory(vecType, alignment, addr[0], mask, nullptr);
+      vecMem = createVaryingMemory(vecType, alignment, addr[0], mask, nullptr, accessedPtr);
     }
 
 
@@ -1849,6 +2267,11 @@ void NatBuilder::vectorizeMemoryInstruction(Instruction *const inst) {
       std::vector<Value *> vals;
       vals.reserve(addr.size());
       for (unsigned i = 0; i < addr.size(); ++i) {
+        // gaps in the group are masked out
+        if (!srcs[i]) {
+          vals.push_back(UndefValue::get(vecType));
+          continue;
+        }
         Value *srcVal = cast<StoreInst>(srcs[i])->getValueOperand();
         Value *val = requestVectorValue(srcVal);
         vals.push_back(val);
@@ -1859,7 +2282,7 @@ void NatBuilder::vectorizeMemoryInstruction(Instruction *const inst) {
       assert(addr.size() == 1 && "multiple addresses for single access!");
       Value *mappedStoredVal = addrShape.isUniform() ? requestScalarValue(storedValue)
                                                        : requestVectorValue(storedValue);
-      vecMem = createVaryingMemory(vecType, alignment, addr[0], mask, mappedStoredVal);
+      vecMem = createVaryingMemory(vecType, alignment, addr[0], mask, mappedStoredVal, accessedPtr);
     }
   }
 
@@ -2026,12 +2449,19 @@ Value *NatBuilder::createUniformMaskedMemory(Instruction *inst, Type *accessedTy
 }
 
 Value *NatBuilder::createVaryingMemory(Type *vecType, llvm::Align alignment, Value *addr, Value *mask,
-                                       Value *values) {
+                                       Value *values, Value *scaPtr) {
   bool scatter(values != nullptr);
   bool maskNonConst(!isa<ConstantVector>(mask));
   maskNonConst ? (scatter ? ++numMaskedScatter : ++numMaskedGather) : (scatter ? ++numScatter : ++numGather);
 
-  if (config.useScatterGatherIntrinsics) {
+  // use the masked intrinsics if the target supports them
+  bool useIntrinsics = config.useScatterGatherIntrinsics;
+  auto *TTI = platInfo.getTTI();
+  if (useIntrinsics && TTI) {
+    useIntrinsics = scatter ? TTI->isLegalMaskedScatter(vecType, alignment) : TTI->isLegalMaskedGather(vecType, alignment);
+  }
+
+  if (useIntrinsics) {
     auto * vecPtrTy = addr->getType();
 
     std::vector<Value *> args;
@@ -2046,8 +2476,42 @@ Value *NatBuilder::createVaryingMemory(Type *vecType, llvm::Align alignment, Val
     assert(intr && "scatter/gather not found!");
     return builder.CreateCall(intr, args);
 
-  } else
-    return scatter ? requestCascadeStore(values, addr, alignment.value(), mask) : requestCascadeLoad(addr, alignment.value(), mask);
+  }
+
+  Type *accessedType = cast<VectorType>(vecType)->getElementType();
+  MemEmulation emulation = pickMemEmulation(mask, scaPtr, accessedType, alignment, scatter);
+  return scatter ? requestCascadeStore(values, addr, alignment.value(), mask, emulation)
+                 : requestCascadeLoad(addr, alignment.value(), mask, emulation);
+}
+
+NatBuilder::MemEmulation
+NatBuilder::pickMemEmulation(Value *mask, Value *scaPtr, Type *accessedType, llvm::Align alignment, bool store) {
+  // all lanes access memory
+  auto *constMask = dyn_cast<Constant>(mask);
+  if (constMask && constMask->isAllOnesValue())
+    return MemEmulation::Unconditional;
+
+  // loading from inactive lanes is safe if every lane pointer is dereferenceable
+  if (!store && scaPtr && isDereferenceableAndAlignedPointer(scaPtr, accessedType, alignment, layout))
+    return MemEmulation::Unconditional;
+
+  // the cascade costs one (poorly predictable) branch per lane, the bit loop one branch per active lane.
+  // the bit loop pays off for wider vectors and if the mask is sparse.
+  if (vectorWidth() >= 8)
+    return MemEmulation::MaskBits;
+
+  auto *TTI = platInfo.getTTI();
+  if (TTI) {
+    // prefer the bit loop if trailing zero counts are cheap
+    auto *maskIntTy = IntegerType::get(mask->getContext(), vectorWidth());
+    IntrinsicCostAttributes cttzAttrs(Intrinsic::cttz, maskIntTy, {maskIntTy, i1Ty});
+    auto cttzCost = TTI->getIntrinsicInstrCost(cttzAttrs, TargetTransformInfo::TCK_RecipThroughput);
+    auto branchCost = TTI->getCFInstrCost(Instruction::Br, TargetTransformInfo::TCK_RecipThroughput);
+    if (cttzCost <= branchCost * (vectorWidth() / 2))
+      return MemEmulation::MaskBits;
+  }
+
+  return MemEmulation::Cascade;
 }
 
 void NatBuilder::createInterleavedMemory(Type *vecType, llvm::Align alignment, std::vector<Value *> *addr, std::vector<Value *> *masks,
@@ -2057,6 +2521,17 @@ void NatBuilder::createInterleavedMemory(Type *vecType, llvm::Align alignment, s
   bool needsMask = masks->size() > 0;
   bool load = values == nullptr;
 
+  // gaps in the group must not be written (stores) or may be out of bounds (trailing gaps of loads)
+  unsigned lastMember = 0;
+  bool hasAnyGaps = false;
+  for (unsigned i = 0; i < stride; ++i) {
+    if ((*srcs)[i])
+      lastMember = i;
+    else
+      hasAnyGaps = true;
+  }
+  bool hasGaps = load ? lastMember + 1 < stride : hasAnyGaps;
+
   // tranpose mask and values if needed
   ShuffleBuilder maskTransposer(vectorWidth());
   if (needsMask)
@@ -2072,9 +2547,15 @@ void NatBuilder::createInterleavedMemory(Type *vecType, llvm::Align alignment, s
     Value *ptr = (*addr)[i];
     Value *mask = needsMask ? maskTransposer.shuffleToInterleaved(builder, stride, i) : nullptr;
 
-    if (masks->size() == 1 && i == (stride - 1)) {
-      needsMask = true;
-      mask = masks->front();
+    // mask out the gap elements in this part
+    if (hasGaps) {
+      std::vector<Constant *> gapBits;
+      for (unsigned j = 0; j < (unsigned) vectorWidth(); ++j) {
+        unsigned member = (i * vectorWidth() + j) % stride;
+        gapBits.push_back(builder.getInt1((*srcs)[member] || (load && member < lastMember)));
+      }
+      Value *gapMask = ConstantVector::get(gapBits);
+      mask = mask ? builder.CreateAnd(mask, gapMask, "inter_gapmask") : gapMask;
     }
 
     if (load) {
@@ -2083,18 +2564,25 @@ void NatBuilder::createInterleavedMemory(Type *vecType, llvm::Align alignment, s
     } else {
       Value *val = transposer.shuffleToInterleaved(builder, stride, i);
       vecMem = createContiguousStore(val, ptr, alignment, mask);
-      if (i < srcs->size())
+      if ((*srcs)[i])
         mapVectorValue((*srcs)[i], vecMem);
     }
   }
   if (load) {
     // de-interleave and map
     for (unsigned i = 0; i < stride; ++i) {
+      if (!(*srcs)[i])
+        continue;
       vecMem = transposer.shuffleFromInterleaved(builder, stride, i);
-      if (i < srcs->size())
-        mapVectorValue((*srcs)[i], vecMem);
+      mapVectorValue((*srcs)[i], vecMem);
     }
   }
+
+  bool isMasked = needsMask || hasGaps;
+  if (load)
+    isMasked ? ++numInterMaskedLoads : ++numInterLoads;
+  else
+    isMasked ? ++numInterMaskedStores : ++numInterStores;
 }
 
 Value *NatBuilder::createContiguousStore(Value *val, Value *ptr, llvm::Align alignment, Value *mask) {
@@ -2622,29 +3110,40 @@ NatBuilder::requestInterleavedAddress(llvm::Value *const addr, unsigned interlea
   return builder.CreatePointerCast(interAddr, vecPtrType, "inter_cast");
 }
 
+std::string
+NatBuilder::getCascadeFunctionName(VectorType *pointerVectorType, unsigned alignment, bool store, MemEmulation emulation) {
+  std::string name = store ? "nativeCascadeStoreFn" : "nativeCascadeLoadFn";
+  switch (emulation) {
+    case MemEmulation::Cascade: break;
+    case MemEmulation::MaskBits: name += "_bits"; break;
+    case MemEmulation::Unconditional: name += "_uncond"; break;
+  }
+
+  // mangle in the accessed pointer type and alignment
+  std::string typeStr;
+  raw_string_ostream typeOut(typeStr);
+  typeOut << *pointerVectorType;
+  for (char & c : typeOut.str()) {
+    if (!isalnum(c)) c = '_';
+  }
+  return name + "_" + typeStr + "_a" + std::to_string(alignment);
+}
+
 llvm::Value *
-NatBuilder::requestCascadeLoad(Value *vecPtr, unsigned alignment, Value *mask) {
+NatBuilder::requestCascadeLoad(Value *vecPtr, unsigned alignment, Value *mask, MemEmulation emulation) {
   Type *elementPtrType = cast<VectorType>(vecPtr->getType())->getElementType();
   Type *accessedType = cast<PointerType>(elementPtrType)->getElementType();
-  unsigned bitWidth = accessedType->getScalarSizeInBits();
 
-  Function *func = getCascadeFunction(bitWidth, false);
+  auto *ptrVecTy = cast<VectorType>(vecPtr->getType());
+  Module *mod = vecInfo.getScalarFunction().getParent();
+  std::string name = getCascadeFunctionName(ptrVecTy, alignment, false, emulation);
+  Function *func = mod->getFunction(name);
   if (!func) {
-    func = createCascadeMemory(cast<VectorType>(vecPtr->getType()), alignment, cast<VectorType>(mask->getType()),
-                               false);
-    mapCascadeFunction(bitWidth, func, false);
-  }
-
-  // cast call argument to correct type if needed
-  Argument *ptrArg = &*func->arg_begin();
-  Value *callPtr = vecPtr;
-
-  if (ptrArg->getType() != vecPtr->getType()) {
-    callPtr = builder.CreateBitCast(callPtr, ptrArg->getType(), "bc");
+    func = createCascadeMemory(ptrVecTy, alignment, cast<VectorType>(mask->getType()), false, emulation, name);
   }
 
   std::vector<Value *> args;
-  args.push_back(callPtr);
+  args.push_back(vecPtr);
   args.push_back(mask);
   Value *ret = builder.CreateCall(func, args, "cascade_load");
   // cast call result to correct type if needed
@@ -2655,39 +3154,31 @@ NatBuilder::requestCascadeLoad(Value *vecPtr, unsigned alignment, Value *mask) {
   return ret;
 }
 
-Value *NatBuilder::requestCascadeStore(Value *vecVal, Value *vecPtr, unsigned alignment, Value *mask) {
-  unsigned bitWidth = vecVal->getType()->getScalarSizeInBits();
-
-  Function *func = getCascadeFunction(bitWidth, true);
+Value *NatBuilder::requestCascadeStore(Value *vecVal, Value *vecPtr, unsigned alignment, Value *mask, MemEmulation emulation) {
+  auto *ptrVecTy = cast<VectorType>(vecPtr->getType());
+  Module *mod = vecInfo.getScalarFunction().getParent();
+  std::string name = getCascadeFunctionName(ptrVecTy, alignment, true, emulation);
+  Function *func = mod->getFunction(name);
   if (!func) {
-    func = createCascadeMemory(cast<VectorType>(vecPtr->getType()), alignment, cast<VectorType>(mask->getType()),
-                               true);
-    mapCascadeFunction(bitWidth, func, true);
+    func = createCascadeMemory(ptrVecTy, alignment, cast<VectorType>(mask->getType()), true, emulation, name);
   }
 
   // cast call arguments to correct type if needed
-  auto argIt = func->arg_begin();
-  Argument *valArg = &*argIt++;
-  Argument *ptrArg = &*argIt;
+  Argument *valArg = &*func->arg_begin();
   Value *callVal = vecVal;
-  Value *callPtr = vecPtr;
-
   if (valArg->getType() != callVal->getType()) {
     callVal = builder.CreateBitCast(callVal, valArg->getType());
   }
-  if (ptrArg->getType() != callPtr->getType()) {
-    callPtr = builder.CreateBitCast(callPtr, ptrArg->getType());
-  }
 
   std::vector<Value *> args;
   args.push_back(callVal);
-  args.push_back(callPtr);
+  args.push_back(vecPtr);
   args.push_back(mask);
   return builder.CreateCall(func, args);
 }
 
 Function *NatBuilder::createCascadeMemory(VectorType *pointerVectorType, unsigned alignment, VectorType *maskType,
-                                          bool store) {
+                                          bool store, MemEmulation emulation, StringRef name) {
   assert(cast<VectorType>(pointerVectorType)->getElementType()->isPointerTy()
          && "pointerVectorType must be of type vector of pointer!");
   assert(cast<VectorType>(maskType)->getElementType()->isIntegerTy(1)
@@ -2708,9 +3199,9 @@ Function *NatBuilder::createCascadeMemory(VectorType *pointerVectorType, unsigne
   argTypes.push_back(pointerVectorType);
   argTypes.push_back(maskType);
 
-  std::string name = store ? "nativeCascadeStoreFn" : "nativeCascadeLoadFn";
+  // the function is specialized for this module (see getCascadeFunctionName)
   FunctionType *fnType = FunctionType::get(resType, argTypes, false);
-  Function *func = Function::Create(fnType, GlobalValue::LinkageTypes::ExternalLinkage, name, mod);
+  Function *func = Function::Create(fnType, GlobalValue::LinkageTypes::InternalLinkage, name, mod);
 
   auto argIt = func->arg_begin();
   Argument *valVec = nullptr;
@@ -2724,6 +3215,35 @@ Function *NatBuilder::createCascadeMemory(VectorType *pointerVectorType, unsigne
   ptrVec->setName("ptrVec");
   mask->setName("mask");
 
+  // access all lanes without any branches
+  if (emulation == MemEmulation::Unconditional) {
+    builder.SetInsertPoint(BasicBlock::Create(mod->getContext(), "entry", func));
+    Value *resVec = store ? nullptr : UndefValue::get(resType);
+    for (int i = 0; i < vectorWidth(); ++i) {
+      Value *pointerLaneVal = builder.CreateExtractElement(ptrVec, ConstantInt::get(i32Ty, i),
+                                                           "ptr_lane_" + std::to_string(i));
+      if (store) {
+        Value *storeLaneVal = builder.CreateExtractElement(valVec, ConstantInt::get(i32Ty, i),
+                                                           "val_lane_" + std::to_string(i));
+        builder.CreateStore(storeLaneVal, pointerLaneVal)->setAlignment(llvm::Align(alignment));
+      } else {
+        auto *loadInst = builder.CreateLoad(accessedType, pointerLaneVal, "load_lane_" + std::to_string(i));
+        loadInst->setAlignment(llvm::Align(alignment));
+        resVec = builder.CreateInsertElement(resVec, loadInst, ConstantInt::get(i32Ty, i),
+                                             "insert_lane_" + std::to_string(i));
+      }
+    }
+    if (store) builder.CreateRetVoid();
+    else builder.CreateRet(resVec);
+    return func;
+  }
+
+  // iterate over the set bits of the mask only
+  if (emulation == MemEmulation::MaskBits) {
+    createMaskBitsMemory(builder, func, valVec, ptrVec, mask, alignment);
+    return func;
+  }
+
   // create body
   // following function:
   // vector a, mask m, vector r = undef
@@ -2735,7 +3255,6 @@ Function *NatBuilder::createCascadeMemory(VectorType *pointerVectorType, unsigne
   // if(m.w) r.w = *(a.w);
   // return r;
   // example assumes vector width 4 and load. store basically the same
-
   // create blocks. we need <vectorWidth> load blocks, <vectorWidth> condition blocks and one return block
   std::vector<BasicBlock *> condBlocks;
   std::vector<BasicBlock *> loadBlocks;
@@ -2767,7 +3286,7 @@ Function *NatBuilder::createCascadeMemory(VectorType *pointerVectorType, unsigne
       // ... extract value lane i, store val to ptr, branch to next
       Value *storeLaneVal = builder.CreateExtractElement(valVec, ConstantInt::get(i32Ty, i),
                                                          "val_lane_" + std::to_string(i));
-      builder.CreateStore(storeLaneVal, pointerLaneVal);
+      builder.CreateStore(storeLaneVal, pointerLaneVal)->setAlignment(llvm::Align(alignment));
     } else {
       // ... load from pointer, insert to result vector, branch to next
       Value *loadInst = builder.CreateLoad(pointerLaneVal, "load_lane_" + std::to_string(i));
@@ -2795,16 +3314,64 @@ Function *NatBuilder::createCascadeMemory(VectorType *pointerVectorType, unsigne
   return func;
 }
 
-void NatBuilder::mapCascadeFunction(unsigned bitWidth, Function *function, bool store) {
-  if (store) cascadeStoreMap[bitWidth] = function;
-  else cascadeLoadMap[bitWidth] = function;
-}
+void NatBuilder::createMaskBitsMemory(IRBuilder<> &builder, Function *func, Value *valVec, Value *ptrVec,
+                                      Value *mask, unsigned alignment) {
+  // following function:
+  // bits = bitcast(m)
+  // while (bits) {
+  //   i = cttz(bits)
+  //   r[i] = *(a[i]);  (or *(a[i]) = v[i] for stores)
+  //   bits &= bits - 1;
+  // }
+  // return r;
+  auto &context = func->getContext();
+  bool store = valVec != nullptr;
+  Type *resType = func->getReturnType();
+  auto *bitsTy = IntegerType::get(context, vectorWidth());
 
-Function *NatBuilder::getCascadeFunction(unsigned bitWidth, bool store) {
-  auto mapIt = store ? cascadeStoreMap.find(bitWidth) : cascadeLoadMap.find(bitWidth);
-  auto mapEt = store ? cascadeStoreMap.end() : cascadeLoadMap.end();
-  if (mapIt != mapEt) return mapIt->second;
-  return nullptr;
+  BasicBlock *entry = BasicBlock::Create(context, "bits_entry", func);
+  BasicBlock *body = BasicBlock::Create(context, "bits_lane", func);
+  BasicBlock *exit = BasicBlock::Create(context, "bits_end", func);
+
+  builder.SetInsertPoint(entry);
+  Value *bits = builder.CreateBitCast(mask, bitsTy, "mask_bits");
+  Value *zeroBits = ConstantInt::get(bitsTy, 0);
+  builder.CreateCondBr(builder.CreateICmpNE(bits, zeroBits), body, exit);
+
+  builder.SetInsertPoint(body);
+  PHINode *bitsPhi = builder.CreatePHI(bitsTy, 2, "bits");
+  PHINode *resPhi = store ? nullptr : builder.CreatePHI(resType, 2, "res");
+  bitsPhi->addIncoming(bits, entry);
+  if (resPhi) resPhi->addIncoming(UndefValue::get(resType), entry);
+
+  Function *cttzFn = Intrinsic::getDeclaration(func->getParent(), Intrinsic::cttz, {bitsTy});
+  Value *lane = builder.CreateCall(cttzFn, {bitsPhi, builder.getTrue()}, "lane");
+  Value *pointerLaneVal = builder.CreateExtractElement(ptrVec, lane, "ptr_lane");
+  Value *nextRes = nullptr;
+  if (store) {
+    Value *storeLaneVal = builder.CreateExtractElement(valVec, lane, "val_lane");
+    builder.CreateStore(storeLaneVal, pointerLaneVal)->setAlignment(llvm::Align(alignment));
+  } else {
+    auto *loadInst = builder.CreateLoad(cast<VectorType>(resType)->getElementType(), pointerLaneVal, "load_lane");
+    loadInst->setAlignment(llvm::Align(alignment));
+    nextRes = builder.CreateInsertElement(resPhi, loadInst, lane, "insert_lane");
+    resPhi->addIncoming(nextRes, body);
+  }
+
+  // clear the lowest set bit
+  Value *nextBits = builder.CreateAnd(bitsPhi, builder.CreateSub(bitsPhi, ConstantInt::get(bitsTy, 1)), "bits_next");
+  bitsPhi->addIncoming(nextBits, body);
+  builder.CreateCondBr(builder.CreateICmpNE(nextBits, zeroBits), body, exit);
+
+  builder.SetInsertPoint(exit);
+  if (store) {
+    builder.CreateRetVoid();
+  } else {
+    PHINode *retPhi = builder.CreatePHI(resType, 2, "res_end");
+    retPhi->addIncoming(UndefValue::get(resType), entry);
+    retPhi->addIncoming(nextRes, body);
+    builder.CreateRet(retPhi);
+  }
 }
 
 Value *NatBuilder::createPTest(Value *vector, bool isRv_all) {
@@ -3060,7 +3627,7 @@ NatBuilder::materializeOrderedReduction(Reduction & red, PHINode & scaPhi) {
   orderPhi->addIncoming(scaInitValue, vecInitInputBlock);
 // (orderly) reduce vectors into scalars
   IRBuilder<> latchBuilder(&vecLatchBlock, vecLatchBlock.getTerminator()->getIterator());
-  auto & reducedUpdate = CreateVectorReduce(config, latchBuilder, red.kind, *vecLatchInst, orderPhi);
+  auto & reducedUpdate = CreateVectorReduce(config, latchBuilder, red.kind, *vecLatchInst, orderPhi, ReductionMode::Ordered);
   orderPhi->addIncoming(&reducedUpdate, &vecLatchBlock);
 
 // reduce reduction phi for outside users
@@ -3093,7 +3660,7 @@ NatBuilder::materializeOrderedReduction(Reduction & red, PHINode & scaPhi) {
                       IRBuilder<> builder(&userBlock, insertPt->getIterator());
                       // reduce all end-of-iteration values and request value of last iteration
                       auto & foldVec = *builder.CreateSelect(selMask, vecLatchInst, &vecElem, ".red");
-                      auto & reducedVector = CreateVectorReduce(config, builder, red.kind, foldVec, orderPhi);
+                      auto & reducedVector = CreateVectorReduce(config, builder, red.kind, foldVec, orderPhi, ReductionMode::Ordered);
                       return reducedVector;
                     }
     );
@@ -3105,9 +3672,243 @@ NatBuilder::materializeOrderedReduction(Reduction & red, PHINode & scaPhi) {
   vecPhi->eraseFromParent();
 }
 
+void
+NatBuilder::materializeScan(Reduction & red, PHINode & scaPhi) {
+  assert(red.isScan && (red.kind != RedKind::Top) && (red.kind != RedKind::Bot));
+
+  const int vectorWidth = vecInfo.getVectorWidth();
+  auto * vecPhi = getVectorValueAs<PHINode>(scaPhi);
+  auto * intTy = Type::getInt32Ty(scaPhi.getContext());
+
+  auto * inAtZero = dyn_cast<Instruction>(scaPhi.getIncomingValue(0));
+  int latchIdx = (inAtZero && vecInfo.inRegion(*inAtZero)) ? 0 : 1;
+  int initIdx = 1 - latchIdx;
+
+  BasicBlock * vecInitInputBlock = scaPhi.getIncomingBlock(initIdx);
+  BasicBlock * vecLoopInputBlock = getVectorBlock(*scaPhi.getIncomingBlock(latchIdx), true);
+
+  auto * scaLatchInst = cast<Instruction>(scaPhi.getIncomingValue(latchIdx));
+  auto * vecLatchInst = getVectorValueAs<Instruction>(*scaLatchInst);
+
+// scan the reductor inputs in-vector (the condition of a min/max reductor is the first chain element)
+  Instruction * scanInsertPt = vecLatchInst;
+  if (auto * sel = dyn_cast<SelectInst>(scaLatchInst)) {
+    auto * scaCond = dyn_cast<Instruction>(sel->getCondition());
+    if (scaCond && red.contains(*scaCond)) scanInsertPt = getVectorValueAs<Instruction>(*scaCond);
+  }
+
+  std::set<Instruction*> vecChain;
+  std::map<Value*, Value*> scannedInputs;
+  for (auto * elem : red.elements) {
+    if (elem == &scaPhi) continue;
+
+    auto * vecElem = getVectorValueAs<Instruction>(*elem);
+    vecChain.insert(vecElem);
+    for (unsigned i = 0; i < elem->getNumOperands(); ++i) {
+      auto * opInst = dyn_cast<Instruction>(elem->getOperand(i));
+      if (opInst && red.contains(*opInst)) continue; // carried value
+
+      auto * vecOp = vecElem->getOperand(i);
+      auto itScan = scannedInputs.find(vecOp);
+      if (itScan == scannedInputs.end()) {
+        IRBuilder<> scanBuilder(scanInsertPt);
+        itScan = scannedInputs.emplace(vecOp, &CreateVectorScan(scanBuilder, red.kind, *vecOp)).first;
+      }
+      vecElem->setOperand(i, itScan->second);
+    }
+  }
+
+// carry the last running value into the next vector iteration
+  Value * scaInitValue = scaPhi.getIncomingValue(initIdx);
+  IRBuilder<> phBuilder(vecInitInputBlock, vecInitInputBlock->getTerminator()->getIterator());
+  auto * vecInitVal = phBuilder.CreateVectorSplat(vectorWidth, scaInitValue, scaPhi.getName() + ".init");
+  vecPhi->addIncoming(vecInitVal, vecInitInputBlock);
+
+  IRBuilder<> latchBuilder(vecLoopInputBlock, vecLoopInputBlock->getTerminator()->getIterator());
+  auto & lastVal = CreateExtract(latchBuilder, *vecLatchInst, -1);
+  auto * vecCarry = latchBuilder.CreateVectorSplat(vectorWidth, &lastVal, scaPhi.getName() + ".carry");
+  vecPhi->addIncoming(vecCarry, vecLoopInputBlock);
+
+// exclusive scan values: the inclusive values shifted up by one lane (the carried value enters lane 0)
+  std::vector<Constant*> shiftElems;
+  shiftElems.push_back(ConstantInt::get(intTy, 0));
+  for (int i = 1; i < vectorWidth; ++i) {
+    shiftElems.push_back(ConstantInt::get(intTy, vectorWidth + i - 1));
+  }
+
+  Instruction * vecExclusive = nullptr;
+  for (auto itUse = vecPhi->use_begin(); itUse != vecPhi->use_end(); ) {
+    auto & use = *itUse++;
+    auto * userInst = cast<Instruction>(use.getUser());
+    if (vecChain.count(userInst) || userInst == vecExclusive) continue;
+
+    if (!vecExclusive) {
+      IRBuilder<> exclBuilder(vecLatchInst->getParent(), std::next(vecLatchInst->getIterator()));
+      vecExclusive = cast<Instruction>(exclBuilder.CreateShuffleVector(vecPhi, vecLatchInst, ConstantVector::get(shiftElems), scaPhi.getName() + ".excl"));
+    }
+    use.set(vecExclusive);
+  }
+
+// the last running value for outside users
+  repairOutsideUses(*scaLatchInst,
+                    [&](Value & usedVal, BasicBlock & userBlock) ->Value& {
+                      auto * insertPt = userBlock.getFirstNonPHI();
+                      IRBuilder<> builder(&userBlock, insertPt->getIterator());
+                      return CreateExtract(builder, *vecLatchInst, -1);
+                    }
+  );
+}
 
 void
-NatBuilder::materializeVaryingReduction(Reduction & red, PHINode & scaPhi) {
+NatBuilder::materializeCompactIndex(Reduction & red, PHINode & scaPhi) {
+  assert(red.isCompact);
+
+  auto * vecPhi = getVectorValueAs<PHINode>(scaPhi);
+
+  auto * inAtZero = dyn_cast<Instruction>(scaPhi.getIncomingValue(0));
+  int latchIdx = (inAtZero && vecInfo.inRegion(*inAtZero)) ? 0 : 1;
+  int initIdx = 1 - latchIdx;
+
+  BasicBlock * vecInitInputBlock = scaPhi.getIncomingBlock(initIdx);
+  BasicBlock * vecLoopInputBlock = getVectorBlock(*scaPhi.getIncomingBlock(latchIdx), true);
+  auto * scaLatchInst = cast<Instruction>(scaPhi.getIncomingValue(latchIdx));
+
+// the increment executes in the active lanes of its block
+  Instruction * scaInc = nullptr;
+  for (auto * elem : red.elements) {
+    if (isa<BinaryOperator>(elem)) scaInc = elem;
+  }
+  assert(scaInc && "compaction index without increment");
+
+  builder.SetInsertPoint(vecLoopInputBlock->getTerminator());
+  Value * predicate = vecInfo.getPredicate(*scaInc->getParent());
+  Value * incMask = predicate ? requestVectorValue(predicate) : getConstantVector(vectorWidth(), i1Ty, 1);
+  auto * numInc = createVectorMaskSummary(*scaPhi.getType(), incMask, builder, RVIntrinsic::PopCount);
+
+  auto & basePhi = requestCompactBase(scaPhi);
+  auto * nextBase = builder.CreateAdd(&basePhi, numInc, scaPhi.getName() + ".base.next");
+  basePhi.addIncoming(scaPhi.getIncomingValue(initIdx), vecInitInputBlock);
+  basePhi.addIncoming(nextBase, vecLoopInputBlock);
+
+// the final index for outside users
+  repairOutsideUses(*scaLatchInst,
+                    [&](Value & usedVal, BasicBlock & userBlock) ->Value& {
+                      return *nextBase;
+                    }
+  );
+
+  // the lane-wise chain only fed the (replaced) store addresses
+  auto * vecHeader = vecPhi->getParent();
+  IRBuilder<> headerBuilder(vecHeader, vecHeader->getFirstInsertionPt());
+  auto * baseSplat = headerBuilder.CreateVectorSplat(vectorWidth(), &basePhi, scaPhi.getName() + ".splat");
+  mapVectorValue(&scaPhi, baseSplat);
+  vecPhi->replaceAllUsesWith(baseSplat);
+  vecPhi->eraseFromParent();
+}
+
+void
+NatBuilder::materializePayloadReduction(Reduction & red, PHINode & scaPhi) {
+  assert(red.isPayload);
+
+  const int vectorWidth = vecInfo.getVectorWidth();
+  auto & context = scaPhi.getContext();
+  auto * vecPhi = getVectorValueAs<PHINode>(scaPhi);
+
+  auto * inAtZero = dyn_cast<Instruction>(scaPhi.getIncomingValue(0));
+  int latchIdx = (inAtZero && vecInfo.inRegion(*inAtZero)) ? 0 : 1;
+  int initIdx = 1 - latchIdx;
+
+  BasicBlock * vecInitInputBlock = scaPhi.getIncomingBlock(initIdx);
+  BasicBlock * vecLoopInputBlock = getVectorBlock(*scaPhi.getIncomingBlock(latchIdx), true);
+
+  auto * scaLatchSel = cast<SelectInst>(scaPhi.getIncomingValue(latchIdx));
+  auto * vecLatchSel = getVectorValueAs<SelectInst>(*scaLatchSel);
+
+// every lane starts out with the initial payload
+  Value * scaInitValue = scaPhi.getIncomingValue(initIdx);
+  IRBuilder<> phBuilder(vecInitInputBlock, vecInitInputBlock->getTerminator()->getIterator());
+  vecPhi->addIncoming(phBuilder.CreateVectorSplat(vectorWidth, scaInitValue, scaPhi.getName() + ".init"), vecInitInputBlock);
+  vecPhi->addIncoming(vecLatchSel, vecLoopInputBlock);
+
+// track the iteration in which each lane last updated its payload (-1 for the initial payload)
+  auto * stampTy = Type::getInt64Ty(context);
+  auto * vecStampTy = FixedVectorType::get(stampTy, vectorWidth);
+  auto & vecHeader = *vecPhi->getParent();
+
+  auto * iterPhi = PHINode::Create(stampTy, 2, scaPhi.getName() + ".iter", &*vecHeader.begin());
+  auto * stampPhi = PHINode::Create(vecStampTy, 2, scaPhi.getName() + ".stamp", &*vecHeader.begin());
+  iterPhi->addIncoming(ConstantInt::get(stampTy, 0), vecInitInputBlock);
+  stampPhi->addIncoming(Constant::getAllOnesValue(vecStampTy), vecInitInputBlock);
+
+  std::vector<Constant*> laneIds;
+  for (int i = 0; i < vectorWidth; ++i) {
+    laneIds.push_back(ConstantInt::get(stampTy, i));
+  }
+  IRBuilder<> headerBuilder(&vecHeader, vecHeader.getFirstInsertionPt());
+  auto * iterStamps = headerBuilder.CreateAdd(headerBuilder.CreateVectorSplat(vectorWidth, iterPhi), ConstantVector::get(laneIds), scaPhi.getName() + ".now");
+
+  IRBuilder<> selBuilder(vecLatchSel->getParent(), std::next(vecLatchSel->getIterator()));
+  bool updateOnTrue = scaLatchSel->getFalseValue() == &scaPhi;
+  auto * stampUpdate = selBuilder.CreateSelect(vecLatchSel->getCondition(),
+                                               updateOnTrue ? iterStamps : stampPhi,
+                                               updateOnTrue ? stampPhi : iterStamps, scaPhi.getName() + ".stamp.upd");
+
+  IRBuilder<> latchBuilder(vecLoopInputBlock, vecLoopInputBlock->getTerminator()->getIterator());
+  iterPhi->addIncoming(latchBuilder.CreateAdd(iterPhi, ConstantInt::get(stampTy, vectorWidth)), vecLoopInputBlock);
+  stampPhi->addIncoming(stampUpdate, vecLoopInputBlock);
+
+// lane-wise latch value of the key reduction
+  Instruction * vecKeyLatch = nullptr;
+  RedKind keyKind = RedKind::Bot;
+  if (red.keyRed) {
+    for (auto * elem : red.keyRed->elements) {
+      auto * keyPhi = dyn_cast<PHINode>(elem);
+      if (!keyPhi || keyPhi->getParent() != scaPhi.getParent()) continue;
+      auto * scaKeyLatch = cast<Instruction>(keyPhi->getIncomingValueForBlock(scaPhi.getIncomingBlock(latchIdx)));
+      vecKeyLatch = getVectorValueAs<Instruction>(*scaKeyLatch);
+    }
+    assert(vecKeyLatch && "key reduction without header phi");
+    keyKind = red.keyRed->kind;
+  }
+
+// pick the payload of the winning lane for outside users
+  repairOutsideUses(*scaLatchSel,
+                    [&](Value & usedVal, BasicBlock & userBlock) ->Value& {
+                      auto * insertPt = userBlock.getFirstNonPHI();
+                      IRBuilder<> builder(&userBlock, insertPt->getIterator());
+                      Value * candMask = nullptr;
+                      if (vecKeyLatch) {
+                        // lanes that hold the reduced key
+                        auto & keyResult = CreateVectorReduce(config, builder, keyKind, *vecKeyLatch, nullptr);
+                        candMask = builder.CreateICmpEQ(vecKeyLatch, builder.CreateVectorSplat(vectorWidth, &keyResult), "key.cand");
+                      }
+                      return CreatePayloadReduce(config, builder, *vecLatchSel, *stampUpdate, candMask, red.pickFirst);
+                    }
+  );
+}
+
+// the finalization of @red (reduction hint, the RV_RED_ORDER default or the fast-math flags of the reduction)
+static ReductionMode
+GetReductionMode(const Reduction & red, const PHINode & scaPhi) {
+  ReductionMode redMode = ReadReductionModeHint(scaPhi);
+  if (redMode != ReductionMode::Auto) return redMode;
+
+  // process-wide default
+  if (CheckFlag("RV_RED_ORDER")) return ReductionMode::Ordered;
+
+  // fp reductions that may be reassociated use the fastest available reduction
+  bool isFloat = false;
+  bool allReassoc = true;
+  for (auto * elem : red.elements) {
+    if (!isa<BinaryOperator>(elem) || !isa<FPMathOperator>(elem)) continue;
+    isFloat = true;
+    allReassoc &= elem->hasAllowReassoc();
+  }
+  return (isFloat && allReassoc) ? ReductionMode::Intrinsic : ReductionMode::Auto;
+}
+
+void
+NatBuilder::materializeVaryingReduction(Reduction & red, PHINode & scaPhi, ReductionMode redMode) {
   assert((red.kind != RedKind::Top) && (red.kind != RedKind::Bot));
 
   const auto vectorWidth = vecInfo.getVectorWidth();
@@ -3146,7 +3947,7 @@ NatBuilder::materializeVaryingReduction(Reduction & red, PHINode & scaPhi) {
                       // otw, replace with reduced value
                       auto * insertPt = userBlock.getFirstNonPHI();
                       IRBuilder<> builder(&userBlock, insertPt->getIterator());
-                      auto & reducedVector = CreateVectorReduce(config, builder, red.kind, *vecLatchInst, nullptr);
+                      auto & reducedVector = CreateVectorReduce(config, builder, red.kind, *vecLatchInst, nullptr, redMode);
                       return reducedVector;
                     }
   );
@@ -3174,7 +3975,7 @@ NatBuilder::materializeVaryingReduction(Reduction & red, PHINode & scaPhi) {
                       IRBuilder<> builder(&userBlock, insertPt->getIterator());
                       // reduce all end-of-iteration values and request value of last iteration
                       auto & foldVec = *builder.CreateSelect(selMask, vecLatchInst, &vecElem, ".red");
-                      auto & reducedVector = CreateVectorReduce(config, builder, red.kind, foldVec, nullptr);
+                      auto & reducedVector = CreateVectorReduce(config, builder, red.kind, foldVec, nullptr, redMode);
                       return reducedVector;
                     }
     );
@@ -3210,12 +4011,22 @@ void NatBuilder::addValuesToPHINodes() {
     } else if (isVectorLoopHeader && shape.isVarying() && red && red->kind != RedKind::Bot) {
       // reduction phi handling
       IF_DEBUG_NAT { errs() << "-- materializing "; red->dump(); errs() << "\n"; }
-      if (CheckFlag("RV_RED_ORDER")) {
+      ReductionMode redMode = GetReductionMode(*red, *scalPhi);
+      IF_DEBUG_NAT { errs() << "-- reduction mode: " << to_string(redMode) << "\n"; }
+      if (red->isCompact) {
+        materializeCompactIndex(*red, *scalPhi);
+      } else if (red->isScan) {
+        materializeScan(*red, *scalPhi);
+      } else if (redMode == ReductionMode::Ordered && scalType->isFloatingPointTy()) {
         materializeOrderedReduction(*red, *scalPhi);
       } else {
-        materializeVaryingReduction(*red, *scalPhi);
+        materializeVaryingReduction(*red, *scalPhi, redMode);
       }
 
+    } else if (isVectorLoopHeader && shape.isVarying() && red && red->isPayload) {
+      IF_DEBUG_NAT { errs() << "-- materializing "; red->dump(); errs() << "\n"; }
+      materializePayloadReduction(*red, *scalPhi);
+
     } else if (isVectorLoopHeader && red && red->kind == RedKind::Bot && shape.isVarying()) {
       // reduction phi handling
       IF_DEBUG_NAT { errs() << "-- materializing "; red->dump(); errs() << "\n"; }
@@ -3429,6 +4240,9 @@ bool NatBuilder::shouldVectorize(Instruction *inst) {
   return false;
 }
 
+// largest group of interleaved accesses (in elements)
+static const int MaxInterleaveStride = 8;
+
 bool NatBuilder::isInterleaved(Instruction *inst, Value *accessedPtr, int byteSize, std::vector<Value *> &srcs) {
   if (!config.enableInterleaved)
     return false;
@@ -3455,6 +4269,9 @@ bool NatBuilder::isInterleaved(Instruction *inst, Value *accessedPtr, int byteSi
   std::map<Value *, const SCEV *> addrSCEVMap;
   std::map<const SCEV *, Value *> scevInstrMap;
   for (Instruction *instr : instrGroup) {
+    // all members are accessed with the predicate of @inst -> only group accesses of the same block
+    if (instr->getParent() != inst->getParent())
+      continue;
     Value *addrVal = getPointerOperand(instr);
     assert(addrVal && "grouped instruction was not a memory instruction!!");
     // only group strided accesses
@@ -3468,19 +4285,40 @@ bool NatBuilder::isInterleaved(Instruction *inst, Value *accessedPtr, int byteSi
   }
 
   // check if there is an interleaved memory group for our base address
+  if (!addrSCEVMap.count(accessedPtr))
+    return false;
   const MemoryGroup &memGroup = memoryGrouper.getMemoryGroup(addrSCEVMap[accessedPtr]);
-  int stride = addrShape.getStride() / byteSize;
-  bool hasGaps = false;
-  for (unsigned i = 0; i < memGroup.size(); ++i) {
-    if (!memGroup[i]) {
-      hasGaps = true;
-      break;
-    }
-    srcs.push_back(scevInstrMap[memGroup[i]]);
+
+  // the group repeats every <stride> elements
+  int64_t byteStride = addrShape.getStride();
+  if (byteStride % byteSize != 0)
+    return false;
+  int stride = static_cast<int>(byteStride / byteSize);
+  if (stride < 2 || stride > std::min<int>(MaxInterleaveStride, vectorWidth()))
+    return false;
+
+  // members of consecutive lanes must not overlap
+  if (memGroup.size() < 2 || static_cast<int>(memGroup.size()) > stride)
+    return false;
+
+  // one source per member (nullptr for gaps)
+  int numMembers = 0;
+  for (int i = 0; i < stride; ++i) {
+    Value *member = i < static_cast<int>(memGroup.size()) && memGroup[i] ? scevInstrMap[memGroup[i]] : nullptr;
+    srcs.push_back(member);
+    if (member)
+      ++numMembers;
+  }
+
+  // gaps are masked out (only trailing gaps for loads)
+  bool needsGapMask = isa<StoreInst>(inst) ? numMembers < stride : static_cast<int>(memGroup.size()) < stride;
+  if ((needsGapMask && !config.enableMaskedMove) || numMembers < 2) {
+    srcs.clear();
+    return false;
   }
 
-  // we have found a memory group if it has no gaps and the size is bigger than 1
-  return !hasGaps && memGroup.size() > 1 && static_cast<int>(memGroup.size()) == stride;
+  // we have found a (complete or partial) memory group
+  return true;
 }
 
 void NatBuilder::visitMemInstructions() {
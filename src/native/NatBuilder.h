@@ -23,6 +23,7 @@
 #include "llvm/IR/PassManager.h"
 
 #include <llvm/Analysis/MemoryDependenceAnalysis.h>
+#include <llvm/Analysis/OptimizationRemarkEmitter.h>
 #include <llvm/IR/Dominators.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
@@ -51,6 +52,7 @@ namespace rv {
     const llvm::DominatorTree &dominatorTree;
     llvm::MemoryDependenceResults & memDepRes;
     llvm::ScalarEvolution &SE;
+    llvm::OptimizationRemarkEmitter & ORE;
     rv::ReductionAnalysis & reda;
     rv::UndeadMaskAnalysis undeadMasks;
 
@@ -62,8 +64,31 @@ namespace rv {
     // the predicate argument in the vector function (WFV mode)
     llvm::Value * vecMaskArg;
 
+    // code generation counters of this region
+    unsigned numMaskedGather = 0, numMaskedScatter = 0, numGather = 0, numScatter = 0,
+        numInterMaskedLoads = 0, numInterMaskedStores = 0, numInterLoads = 0, numInterStores = 0,
+        numContMaskedLoads = 0, numContMaskedStores = 0, numContLoads = 0, numContStores = 0,
+        numUniMaskedLoads = 0, numUniMaskedStores = 0, numUniLoads = 0, numUniStores = 0,
+        numUniAllocas = 0, numSlowAllocas = 0;
+    unsigned numVecGEPs = 0, numScalGEPs = 0, numInterGEPs = 0, numVecBCs = 0, numScalBCs = 0;
+    unsigned numVecCalls = 0, numSemiCalls = 0, numFallCalls = 0, numCascadeCalls = 0, numRVIntrinsics = 0;
+    unsigned numScalarized = 0, numVectorized = 0, numFallbacked = 0, numLazy = 0;
+    unsigned numConstLoadMasks = 0, numUniLoadMasks = 0, numVarLoadMasks = 0;
+    unsigned numConstStoreMasks = 0, numUniStoreMasks = 0, numVarStoreMasks = 0;
+
+    // report the counters of this region (and add them to the NAT_STAT_DUMP totals)
     void printStatistics();
 
+    // named memory access and call counters of this region
+    using StatisticVec = std::vector<std::pair<const char *, unsigned>>;
+    StatisticVec getStatistics() const;
+    // optimization remark with the counters of this region
+    void emitStatisticsRemark();
+    // number of region instructions per shape class (taken before code generation)
+    StatisticVec getShapeStatistics() const;
+    // append a JSON record of this region to the NAT_STAT_JSON file
+    void dumpRegionRecord(const StatisticVec & shapeStats);
+
     rv::VectorShape getVectorShape(const llvm::Value &val);
 
     // get the appropriate integer ty to index into the ptr-typed \p val.
@@ -73,9 +98,18 @@ namespace rv {
     void repairOutsideUses(llvm::Instruction & scaChainInst, std::function<llvm::Value& (llvm::Value &,llvm::BasicBlock &)> repairFunc);
 
     // generate reduction code (after all other instructions have been vectorized)
-    void materializeVaryingReduction(rv::Reduction & red, llvm::PHINode & scaPhi);
+    void materializeVaryingReduction(rv::Reduction & red, llvm::PHINode & scaPhi, rv::ReductionMode redMode);
     void materializeOrderedReduction(rv::Reduction & red, llvm::PHINode & scaPhi);
 
+    // materialize a prefix scan (in-vector scan of the reductor inputs, the last lane is carried)
+    void materializeScan(rv::Reduction & red, llvm::PHINode & scaPhi);
+
+    // materialize the payload of a paired reduction (lane-wise select, tie-breaking pick of a lane for outside users)
+    void materializePayloadReduction(rv::Reduction & red, llvm::PHINode & scaPhi);
+
+    // materialize a stream compaction index (scalar running index advanced by the popcount of the increment mask)
+    void materializeCompactIndex(rv::Reduction & red, llvm::PHINode & scaPhi);
+
     // materialize a recurrence pattern (SCC only consists of phis and selects)
     void materializeRecurrence(rv::Reduction & red, llvm::PHINode & scaPhi);
 
@@ -147,12 +181,32 @@ namespace rv {
     void vectorizeNumLanesCall(llvm::CallInst *rvCall);
 
     void vectorizeAtomicRMW(llvm::AtomicRMWInst *const atomicrmw);
+    // single atomic on @ptr that combines the operands of the lanes in @mask, returns the lane-wise results (nullptr if unused)
+    llvm::Value* createCombinedAtomicRMW(llvm::AtomicRMWInst & atomicrmw, rv::RedKind redKind, llvm::Value & ptr, llvm::Value & vecVal, llvm::Value & mask);
+    // uniform address under a divergent mask: one atomic if any lane is active
+    void vectorizeMaskedAtomicRMW(llvm::AtomicRMWInst & atomicrmw, rv::RedKind redKind);
+    // varying addresses: one atomic per distinct address (conflicting lanes are combined in registers)
+    void vectorizeConflictingAtomicRMW(llvm::AtomicRMWInst & atomicrmw, rv::RedKind redKind);
+
+    // the stream compaction index that addresses @store (or nullptr)
+    llvm::PHINode* getCompactIndex(llvm::StoreInst & store);
+    // store the active lanes contiguously at the running index of @scaIdxPhi
+    void vectorizeCompactStore(llvm::StoreInst & store, llvm::PHINode & scaIdxPhi);
+    // the scalar running index of the vector loop for the compaction index @scaIdxPhi
+    llvm::PHINode& requestCompactBase(llvm::PHINode & scaIdxPhi);
+
+    // compact the lanes of @vecVal where @maskVal is set into the lower lanes
+    // (native compress on AVX-512, 8-lane lookup tables otherwise; wider vectors are split and merged)
+    llvm::Value* createCompact(llvm::Value & vecVal, llvm::Value & maskVal);
 
     // create a lookup table for an efficient compaction intrinsic
     llvm::Constant* createCompactLookupTable(unsigned vecWidth);
 
     void vectorizeAlloca(llvm::AllocaInst *const allocaInst);
 
+    // count executions and active lanes of @scaBlock at the current insertion point (RV_PROFILE_LANES)
+    void instrumentLaneOccupancy(llvm::BasicBlock & scaBlock);
+
     // implement the mask summary function @mode (ballot/popcount) of @vecVal with @builder
     llvm::Value* createVectorMaskSummary(llvm::Type & indexTy, llvm::Value * vecVal, llvm::IRBuilder<> & builder, rv::RVIntrinsic mode);
 
@@ -168,13 +222,12 @@ namespace rv {
                          unsigned laneIdx = 0);
 
     llvm::SmallPtrSet<llvm::Instruction *, 16> keepScalar;
-    llvm::DenseMap<unsigned, llvm::Function *> cascadeLoadMap;
-    llvm::DenseMap<unsigned, llvm::Function *> cascadeStoreMap;
     llvm::DenseMap<const llvm::Value *, llvm::Value *> vectorValueMap;
     std::map<const llvm::Value *, LaneValueVector> scalarValueMap;
     std::map<const llvm::BasicBlock *, BasicBlockVector> basicBlockMap;
     std::map<const llvm::Type *, rv::MemoryAccessGrouper> grouperMap;
     std::vector<llvm::PHINode *> phiVector;
+    std::map<const llvm::PHINode *, llvm::PHINode *> compactBaseMap;
     std::deque<llvm::Instruction *> lazyInstructions;
 
     void addLazyInstruction(llvm::Instruction *const instr);
@@ -193,14 +246,24 @@ namespace rv {
     llvm::Value *requestInterleavedGEP(llvm::GetElementPtrInst *const gep, unsigned interleavedIdx);
     llvm::Value *requestInterleavedAddress(llvm::Value *const addr, unsigned interleavedIdx, llvm::Type *const vecType);
 
-    llvm::Value *requestCascadeLoad(llvm::Value *vecPtr, unsigned alignment, llvm::Value *mask);
-    llvm::Value *requestCascadeStore(llvm::Value *vecVal, llvm::Value *vecPtr, unsigned alignment, llvm::Value *mask);
+    // branch-free/less branchy emulation of gathers and scatters (if the masked intrinsics are not available)
+    enum class MemEmulation {
+      Cascade, // one branch per lane
+      MaskBits, // loop over the set mask bits (cttz)
+      Unconditional // access all lanes (unmasked or dereferenceable)
+    };
+    MemEmulation pickMemEmulation(llvm::Value *mask, llvm::Value *scaPtr, llvm::Type *accessedType, llvm::Align alignment, bool store);
+
+    llvm::Value *requestCascadeLoad(llvm::Value *vecPtr, unsigned alignment, llvm::Value *mask, MemEmulation emulation);
+    llvm::Value *requestCascadeStore(llvm::Value *vecVal, llvm::Value *vecPtr, unsigned alignment, llvm::Value *mask, MemEmulation emulation);
     llvm::Function *createCascadeMemory(llvm::VectorType *pointerVectorType, unsigned alignment,
-                                        llvm::VectorType *maskType, bool store);
+                                        llvm::VectorType *maskType, bool store, MemEmulation emulation, llvm::StringRef name);
+    void createMaskBitsMemory(llvm::IRBuilder<> &builder, llvm::Function *func, llvm::Value *valVec, llvm::Value *ptrVec,
+                              llvm::Value *mask, unsigned alignment);
 
     llvm::Value* getSplat(llvm::Constant* Elt);
-    void mapCascadeFunction(unsigned bitWidth, llvm::Function *function, bool store);
-    llvm::Function *getCascadeFunction(unsigned bitWidth, bool store);
+    // emulation functions are specialized on the accessed type, alignment and lowering
+    std::string getCascadeFunctionName(llvm::VectorType *pointerVectorType, unsigned alignment, bool store, MemEmulation emulation);
 
     llvm::Value& widenScalar(llvm::Value & scaValue, VectorShape vecShape);
     bool hasUniformPredicate(const llvm::BasicBlock & BB) const;
@@ -229,7 +292,7 @@ namespace rv {
                                            llvm::Value *addr, llvm::Value * scalarMask, llvm::Value *vectorMask, llvm::Value *values);
 
     llvm::Value *createVaryingMemory(llvm::Type *vecType, llvm::Align alignment, llvm::Value *addr, llvm::Value *mask,
-                                     llvm::Value *values);
+                                     llvm::Value *values, llvm::Value *scaPtr = nullptr);
     void createInterleavedMemory(llvm::Type *vecType, llvm::Align alignment, std::vector<llvm::Value *> *addr, std::vector<llvm::Value *> *mask,
                                      std::vector<llvm::Value *> *values, std::vector<llvm::Value *> *srcs);
 
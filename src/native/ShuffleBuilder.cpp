@@ -101,76 +101,49 @@ llvm::Value *ShuffleBuilder::shuffleFromInterleaved(llvm::IRBuilder<> &builder,
 }
 
 llvm::Value *ShuffleBuilder::shuffleToInterleaved(llvm::IRBuilder<> &builder, unsigned stride, unsigned start) {
-  if (cropped)
-    prepareCroppedVector(builder);
+  assert(!cropped && "interleaved shuffles expect full-width input vectors");
 
-  // expects that the values of each input vector are NOT interleaved. creates an interleaved value
-  // use a loop that builds shuffles until all <vectorWidth> positions are set
-  // shuffles are build like this: take the last shuffle and the next input vector and the shuffle mask
-  // as shuffle mask: all positions that have been set in lastShuffle, then all undef positions (will be k * stride)
-  // set to <vecWidth> + k. the shuffle that is build becomes the new last shuffle
-  // initialize like this: last shuffle = inputVectors[0], next input vector = inputVectors[1],
-  // shuffleMask = <[k * stride](=m1)> for all m1 < vectorWidth
-  // lastly, return lastShuffle
+  // expects that the values of each input vector are NOT interleaved. creates the interleaved part <start>:
+  // position j of the result holds element k = start * vectorWidth + j of the interleaved sequence,
+  // which is lane (k / stride) of input vector (k % stride).
+  // the input vectors are blended in one after another: positions that have been set in lastShuffle keep their
+  // index, positions of the next input get <vectorWidth> + lane. all other positions remain undef for now.
+  // this works for any stride (not only for divisors of the vector width)
 
   Type *i32Ty = builder.getInt32Ty();
 
-  assert(inputVectors.size() >= 2 && "not enough input vectors to build shuffle");
-  unsigned inputVectorIndex = ((vectorWidth % stride) * start) % static_cast<unsigned>(inputVectors.size());
-  Value *lastShuffle = inputVectors[inputVectorIndex];
-  Value *nextInput;
+  assert(inputVectors.size() == stride && "expected one input vector per interleaved member");
   std::vector<Constant *> shuffleMask(vectorWidth, UndefValue::get(i32Ty));
-  inputVectorIndex = (inputVectorIndex + 1) % static_cast<unsigned>(inputVectors.size());
-  unsigned counter = 1;
+  Value *lastShuffle = nullptr;
 
-  // index init
-  unsigned i = (vectorWidth / stride) * start;
-  unsigned index = 0;
-  while (index < vectorWidth) {
-    Constant *constIdx = ConstantInt::get(i32Ty, i);
-    shuffleMask[index] = constIdx;
-    ++i;
-    index += stride;
-  }
-
-  do {
-    nextInput = inputVectors[inputVectorIndex];
-
-    // set shuffle mask for next input
-    i = ((vectorWidth / stride) * start) + vectorWidth;
-    index = counter;
-    while (index < vectorWidth) {
-      Constant *constIdx = ConstantInt::get(i32Ty, i);
-      shuffleMask[index] = constIdx;
-      ++i;
-      index += stride;
+  for (unsigned member = 0; member < stride; ++member) {
+    bool usesMember = false;
+    for (unsigned j = 0; j < vectorWidth; ++j) {
+      unsigned k = start * vectorWidth + j;
+      if (k % stride != member)
+        continue;
+      unsigned lane = k / stride;
+      shuffleMask[j] = ConstantInt::get(i32Ty, lastShuffle ? vectorWidth + lane : lane);
+      usesMember = true;
     }
-
-    // if we create the right-most transposition for pseudo-shuffling, remove the very last index in the last iteration
-    // to get a vector size conform with the cropped size
-    if (start == inputVectors.size() - 1 && counter == inputVectors.size() - 1 && cropped)
-      for (unsigned k = 1; k < inputVectors.size(); ++k) {
-        shuffleMask.pop_back();
-      }
+    if (!usesMember)
+      continue;
 
     // create shuffle
     Value *idxVector = ConstantVector::get(shuffleMask);
-    lastShuffle = builder.CreateShuffleVector(lastShuffle, nextInput, idxVector, "native_shuffle");
-
-    // prepare next iteration
-    inputVectorIndex = (inputVectorIndex + 1) % static_cast<unsigned>(inputVectors.size());
-    ++counter;
+    Value *nextInput = inputVectors[member];
+    if (lastShuffle)
+      lastShuffle = builder.CreateShuffleVector(lastShuffle, nextInput, idxVector, "native_shuffle");
+    else
+      lastShuffle = builder.CreateShuffleVector(nextInput, UndefValue::get(nextInput->getType()), idxVector, "native_shuffle");
 
     // loop over the shuffle mask and replace the already set positions with identity constant
-    for (i = 0; i < vectorWidth; ++i) {
-      Constant *constIdx = shuffleMask[i];
-      if (isa<UndefValue>(constIdx))
+    for (unsigned i = 0; i < vectorWidth; ++i) {
+      if (isa<UndefValue>(shuffleMask[i]))
         continue;
-      constIdx = ConstantInt::get(i32Ty, i);
-      shuffleMask[i] = constIdx;
+      shuffleMask[i] = ConstantInt::get(i32Ty, i);
     }
-
-  } while (counter < inputVectors.size());
+  }
 
   return lastShuffle;
 }
@@ -16,8 +16,12 @@
 // RV_REPORT_FILE stream handle
 static std::unique_ptr<llvm::raw_fd_ostream> outFileStream;
 
+// per-thread report buffer (worker threads must not write to the shared stream)
+static thread_local llvm::raw_ostream * threadStream = nullptr;
+
 static llvm::raw_ostream &
 reps() {
+  if (threadStream) return *threadStream;
   if (outFileStream) return *outFileStream;
 
   // no reporting
@@ -47,6 +51,11 @@ CheckFlag(const char * flagName) {
   else return *envVal != '0';
 }
 
+void
+SetThreadReportStream(llvm::raw_ostream * out) {
+  threadStream = out;
+}
+
 // report stream (TODO use llvm optimization log stream)
 llvm::raw_ostream &
 Report() {
@@ -23,6 +23,9 @@ llvm::raw_ostream & Report();
 // continue a "rv: " line started with "Report()"
 llvm::raw_ostream & ReportContinue();
 
+// redirect the Report() output of the calling thread to @out (nullptr: back to the shared stream)
+void SetThreadReportStream(llvm::raw_ostream * out);
+
 // output stream for error
 llvm::raw_ostream & Error();
 
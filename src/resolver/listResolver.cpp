@@ -145,7 +145,8 @@ ListResolver::ForAll_MappingsForCall(std::function<bool(const VectorMapping&)> M
 
 class
 MappedFunctionResolver : public FunctionResolver {
-  const VectorMapping & mapping;
+  // a copy: resolvers outlive later changes to the mapping list (PlatformInfo caches them)
+  const VectorMapping mapping;
 
 public:
   MappedFunctionResolver(const VectorMapping & mapping)
@@ -29,7 +29,6 @@
 #include "rv/transform/loopExitCanonicalizer.h"
 #include "report.h"
 
-#include <llvm/IR/Verifier.h>
 #include <vector>
 #include <sstream>
 
@@ -243,8 +242,90 @@ static const unsigned char** extraModuleBuffers[] = {
 
 
 
-static Module *sleefModules[SLEEF_Enum_Entries * 2];
-static Module *extraModules[SLEEF_Enum_Entries * 2];
+// parse ULP error bound from mangled SLEEF name
+static unsigned
+ReadULPBound(StringRef sleefName) {
+  auto itStart = sleefName.rfind("_u");
+  if (itStart == StringRef::npos) return 0; // unspecified -> perfect rounding
+  StringRef ulpPart = sleefName.substr(itStart + 2);
+
+  // single digit ULP value
+  unsigned ulpBound;
+  if (ulpPart.size() == 1) {
+    ulpBound = 10 * (ulpPart[0] - '0');
+
+  // lsc is tenth of ULP
+  } else {
+    bool parseError = ulpPart.consumeInteger<unsigned>(10, ulpBound);
+    (void) parseError; assert(!parseError);
+  }
+
+  return ulpBound;
+}
+
+// implementation of a SLEEF function with a specific precision
+struct SleefVariant {
+  unsigned ulpBound; // in tenth of ULP
+  Function * func;
+};
+
+// SLEEF base name (eg "xsinf") -> all ULP variants in the module ("xsinf", "xsinf_u1", ..)
+// The variants are sorted from least to most precise.
+using SleefFuncIndex = StringMap<SmallVector<SleefVariant, 2>>;
+
+// Lazily loaded SLEEF modules of one SleefResolverService (and its PlatformInfo).
+// Only the bodies of functions that are actually linked into a user module get parsed.
+// The cache owns the modules and frees them with the resolver service, ie before the context of the user module dies.
+struct SleefModuleCache {
+  LLVMContext & context;
+
+  std::unique_ptr<Module> sleefModules[SLEEF_Enum_Entries * 2];
+  SleefFuncIndex sleefIndex[SLEEF_Enum_Entries * 2];
+  std::unique_ptr<Module> extraModules[SLEEF_Enum_Entries];
+
+  SleefModuleCache(LLVMContext & _context)
+  : context(_context)
+  {}
+
+  Module * requestExtraModule(SleefISA isa) {
+    int modIdx = (int) isa;
+    auto & mod = extraModules[modIdx];
+    if (!mod) mod.reset(createLazyModuleFromBuffer(reinterpret_cast<const char*>(extraModuleBuffers[modIdx]), extraModuleBufferLens[modIdx], context));
+    return mod.get();
+  }
+
+  // the index of all SLEEF function implementations in the module (nullptr if the module is n/a)
+  const SleefFuncIndex * requestSleefIndex(SleefISA isa, bool doublePrecision) {
+    auto modIndex = sleefModuleIndex(isa, doublePrecision);
+    auto & mod = sleefModules[modIndex];
+    if (mod) return &sleefIndex[modIndex];
+
+    mod.reset(createLazyModuleFromBuffer(reinterpret_cast<const char*>(sleefModuleBuffers[modIndex]), sleefModuleBufferLens[modIndex], context));
+    if (!mod) return nullptr;
+
+    // only scans the symbol table - function bodies stay unparsed
+    auto & index = sleefIndex[modIndex];
+    for (auto & func : *mod) {
+      if (func.isDeclaration()) continue;
+      StringRef baseName = func.getName().split('_').first;
+      index[baseName].push_back(SleefVariant{ReadULPBound(func.getName()), &func});
+    }
+    for (auto & itVariants : index) {
+      std::stable_sort(itVariants.second.begin(), itVariants.second.end(),
+          [](const SleefVariant & A, const SleefVariant & B) { return A.ulpBound > B.ulpBound; });
+    }
+    return &index;
+  }
+};
+
+// parse the body of the SLEEF function @func (returns false and reports if that fails)
+static bool
+MaterializeSleefFunction(Function & func) {
+  std::string errorText;
+  if (materializeLazyFunction(func, errorText)) return true;
+  Report() << "sleef: could not load " << func.getName() << ": " << errorText << "\n";
+  return false;
+}
 
 static
 void
@@ -391,11 +472,6 @@ class SleefResolverService : public ResolverService {
 
     PlainVecDescVector commonVectorMappings;
 
-    void addNamedMappings(const PlainVecDescVector & funcs, bool givePrecedence) {
-      auto itInsert = givePrecedence ? commonVectorMappings.begin() : commonVectorMappings.end();
-      commonVectorMappings.insert(itInsert, funcs.begin(), funcs.end());
-    }
-
     ArchFunctionList(SleefISA _isaIndex, std::string _archSuffix)
     : isaIndex(_isaIndex)
     , archSuffix(_archSuffix)
@@ -404,8 +480,42 @@ class SleefResolverService : public ResolverService {
 
   std::vector<ArchFunctionList*> archLists;
 
+  // a SLEEF implementation of a scalar function for one ISA
+  struct SleefMapping {
+    ArchFunctionList * archList;
+    PlainVecDesc desc;
+
+    // least precise implementation within config.maxULPErrorBound ([0] single, [1] double precision)
+    Function * impl[2];
+    bool hasImpl[2];
+
+    SleefMapping(ArchFunctionList * _archList, const PlainVecDesc & _desc)
+    : archList(_archList)
+    , desc(_desc)
+    , impl{nullptr, nullptr}
+    , hasImpl{false, false}
+    {}
+  };
+
+  // scalar function name -> SLEEF mappings (in arch precedence order)
+  StringMap<SmallVector<SleefMapping, 4>> mappingIndex;
+
+  void buildMappingIndex() {
+    for (auto * archList : archLists) {
+      for (const auto & vd : archList->commonVectorMappings) {
+        mappingIndex[vd.scalarFnName].emplace_back(archList, vd);
+      }
+    }
+  }
+
   Config config;
 
+  // SLEEF modules (in the context of platInfo's module)
+  std::unique_ptr<SleefModuleCache> moduleCache;
+  SleefModuleCache & requestModuleCache(LLVMContext & context) {
+    if (!moduleCache) moduleCache = std::make_unique<SleefModuleCache>(context);
+    return *moduleCache;
+  }
 
 public:
   void
@@ -468,6 +578,7 @@ public:
 
     archLists.push_back(vlaArch);
 
+    buildMappingIndex();
   }
 
   ~SleefResolverService() {
@@ -663,61 +774,25 @@ struct SleefVLAResolver : public FunctionResolver {
 using VecMappingShortVec = llvm::SmallVector<VectorMapping, 4>;
 using VectorFuncMap = std::map<const llvm::Function *, VecMappingShortVec*>;
 
-// parse ULP error bound from mangled SLEEF name
-static unsigned
-ReadULPBound(StringRef sleefName) {
-  auto itStart = sleefName.find_last_of("_u");
-  if (itStart == StringRef::npos) return 0; // unspecified -> perfect rounding
-  StringRef ulpPart = sleefName.substr(itStart + 1);
-
-  // single digit ULP value
-  unsigned ulpBound;
-  if (ulpPart.size() == 1) {
-    ulpBound = 10 * (ulpPart[0] - '0');
-
-  // lsc is tenth of ULP
-  } else {
-    bool parseError = ulpPart.consumeInteger<unsigned>(10, ulpBound);
-    (void) parseError; assert(!parseError);
-  }
-
-  return ulpBound;
-}
-
 static Function*
-GetLeastPreciseImpl(Module & mod, const std::string & funcPrefix, const unsigned maxULPBound) {
-  Function * currBest = nullptr;
-  unsigned bestBound = 0;
-
+GetLeastPreciseImpl(const SleefFuncIndex & index, const std::string & funcPrefix, const unsigned maxULPBound) {
   IF_DEBUG_SLEEF { errs() << "SLEEF: impl: " << funcPrefix << "\n"; }
-  for (auto & func : mod) {
-    if (func.isDeclaration()) continue;
-    if (!func.getName().startswith(funcPrefix)) continue;
-
-    // not a complete funcname match (ie "xlog" would otw match "xlog1p")
-    if ((func.getName().size() > funcPrefix.size()) &&
-        (func.getName()[funcPrefix.size()] != '_'))
-    {
-        continue;
-    }
+  auto itVariants = index.find(funcPrefix);
+  if (itVariants == index.end()) return nullptr;
 
-    IF_DEBUG_SLEEF { errs() << "\t candidate: " << func.getName() << "\n"; }
-
-    unsigned funcBound = ReadULPBound(func.getName());
+  // variants are sorted by descending ULP error bound
+  for (const auto & variant : itVariants->second) {
     // dismiss too imprecise functions
-    if (funcBound > maxULPBound) {
-      IF_DEBUG_SLEEF { errs() << "discard, ulp was: " << funcBound << "\n"; }
+    if (variant.ulpBound > maxULPBound) {
+      IF_DEBUG_SLEEF { errs() << "\tdiscard " << variant.func->getName() << ", ulp was: " << variant.ulpBound << "\n"; }
       continue;
-
-    // accept functions with higher ULP error within maxUPLBound
-    } else if (!currBest || (funcBound > bestBound)) {
-      IF_DEBUG_SLEEF { errs() << "\tOK! " << func.getName() << " with ulp bound: " << funcBound << "\n"; }
-      bestBound = funcBound;
-      currBest = &func;
     }
+
+    IF_DEBUG_SLEEF { errs() << "\tOK! " << variant.func->getName() << " with ulp bound: " << variant.ulpBound << "\n"; }
+    return variant.func;
   }
 
-  return currBest;
+  return nullptr;
 }
 
 std::unique_ptr<FunctionResolver>
@@ -727,25 +802,26 @@ SleefResolverService::resolve(llvm::StringRef funcName, llvm::FunctionType & sca
   (void) hasPredicate; // FIXME use predicated versions
 
   // Otw, start looking for a SIMD-ized implementation
-  ArchFunctionList * archList = nullptr;
-  PlainVecDesc funcDesc;
-  for (auto * candList : archLists) {
-    // query custom mappings with precedence
-    std::string funcNameStr = funcName.str();
-    for (const auto & vd : candList->commonVectorMappings) {
-       if (vd.scalarFnName == funcNameStr &&
-          ((vd.vectorWidth <= 0) || (vd.vectorWidth == vectorWidth)))
-       {
-         funcDesc = vd;
-         archList = candList;
-         break;
-       }
-    };
-
-    if (archList) break;
+  auto itMappings = mappingIndex.find(funcName);
+  if (itMappings == mappingIndex.end()) {
+    IF_DEBUG_SLEEF { errs() << "\tsleef: n/a\n"; }
+    return nullptr;
+  }
+
+  SleefMapping * mapping = nullptr;
+  for (auto & candMapping : itMappings->second) {
+    int mappedWidth = candMapping.desc.vectorWidth;
+    if ((mappedWidth <= 0) || (mappedWidth == vectorWidth)) {
+      mapping = &candMapping;
+      break;
+    }
+  }
+  if (!mapping) {
+    IF_DEBUG_SLEEF { errs() << "\tsleef: n/a\n"; }
+    return nullptr;
   }
-  IF_DEBUG_SLEEF { errs() << "\tsleef: n/a\n"; }
-  if (!archList) return nullptr;
+  ArchFunctionList * archList = mapping->archList;
+  const PlainVecDesc & funcDesc = mapping->desc;
 
   // decode bitwidth (for module lookup)
   bool doublePrecision = false;
@@ -758,16 +834,16 @@ SleefResolverService::resolve(llvm::StringRef funcName, llvm::FunctionType & sca
   // remove the trailing isa specifier (_avx2/_avx/_sse/..)
   SleefISA isa = archList->isaIndex;
 
-  std::string sleefName = funcDesc.vectorFnName;
+  const std::string & sleefName = funcDesc.vectorFnName;
 
   // TODO factor out
   bool isExtraFunc = funcDesc.vectorFnName.find("_extra") != std::string::npos;
   if (isExtraFunc) {
-    int modIdx = (int) isa;
-    auto *& mod = extraModules[modIdx];
-    if (!mod) mod = createModuleFromBuffer(reinterpret_cast<const char*>(extraModuleBuffers[modIdx]), extraModuleBufferLens[modIdx], context);
+    auto * mod = requestModuleCache(context).requestExtraModule(isa);
+    if (!mod) return nullptr;
     Function *vecFunc = mod->getFunction(sleefName);
     assert(vecFunc && "mapped extra function not found in module!");
+    if (!MaterializeSleefFunction(*vecFunc)) return nullptr;
     return std::make_unique<SleefLookupResolver>(destModule, /* RNG result */ VectorShape::varying(), *vecFunc, funcDesc.vectorFnName);
   }
 
@@ -781,21 +857,18 @@ SleefResolverService::resolve(llvm::StringRef funcName, llvm::FunctionType & sca
     return std::make_unique<SleefLookupResolver>(destModule, VectorShape::varying(), *vecFunc, vecFunc->getName().str());
   }
 
-  // Look in SLEEF module
-  auto modIndex = sleefModuleIndex(isa, doublePrecision);
-  llvm::Module*& mod = sleefModules[modIndex]; // TODO const Module
-  if (!mod) {
-    mod = createModuleFromBuffer(reinterpret_cast<const char*>(sleefModuleBuffers[modIndex]), sleefModuleBufferLens[modIndex], context);
-
-    IF_DEBUG {
-      bool brokenMod = verifyModule(*mod, &errs());
-      if (brokenMod) abort();
-    }
+  // Look in SLEEF module (memoized per precision)
+  Function *& implFunc = mapping->impl[doublePrecision];
+  if (!mapping->hasImpl[doublePrecision]) {
+    mapping->hasImpl[doublePrecision] = true;
+    const auto * sleefIndex = requestModuleCache(context).requestSleefIndex(isa, doublePrecision);
+    if (sleefIndex) implFunc = GetLeastPreciseImpl(*sleefIndex, sleefName, config.maxULPErrorBound);
+    if (implFunc && !MaterializeSleefFunction(*implFunc)) implFunc = nullptr;
   }
 
   if (isa == SLEEF_VLA) {
     // on-the-fly vectorization module
-    Function *vlaFunc = GetLeastPreciseImpl(*mod, sleefName, config.maxULPErrorBound);
+    Function *vlaFunc = implFunc;
     if (!vlaFunc) {
       IF_DEBUG_SLEEF { errs() << "sleef: " << sleefName << " n/a with maxULPError: " << config.maxULPErrorBound << "\n"; }
       return nullptr;
@@ -814,7 +887,7 @@ SleefResolverService::resolve(llvm::StringRef funcName, llvm::FunctionType & sca
     }
 
     // we'll have to link in the function
-    Function *vecFunc = GetLeastPreciseImpl(*mod, sleefName, config.maxULPErrorBound);
+    Function *vecFunc = implFunc;
     if (!vecFunc) {
       IF_DEBUG_SLEEF { errs() << "sleef: " << sleefName << " n/a with maxULPError: " << config.maxULPErrorBound << "\n"; }
       return nullptr;
@@ -18,6 +18,9 @@
 #include <llvm/IR/Dominators.h>
 #include <llvm/IR/Verifier.h>
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/PassTimingInfo.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/Timer.h"
 
 #include "rv/rv.h"
 #include "rv/analysis/VectorizationAnalysis.h"
@@ -30,6 +33,7 @@
 #include "rv/PlatformInfo.h"
 #include "rv/vectorizationInfo.h"
 #include "rv/analysis/reductionAnalysis.h"
+#include "rv/analysis/LaneProfile.h"
 
 #include "rv/transform/Linearizer.h"
 
@@ -59,6 +63,19 @@ using namespace llvm;
 
 namespace rv {
 
+// compile time of a vectorizer phase (-time-passes per phase, -ftime-trace per function and region)
+// the -time-passes timers are process-wide and only run if config.enablePhaseTimers is set
+class PhaseTimer {
+  NamedRegionTimer regionTimer;
+  TimeTraceScope traceScope;
+
+public:
+  PhaseTimer(StringRef phaseName, VectorizationInfo & vecInfo, const Config & config)
+  : regionTimer(phaseName, phaseName, "rv", "Region Vectorizer", TimePassesIsEnabled && config.enablePhaseTimers)
+  , traceScope(phaseName, [&]() { return (vecInfo.getScalarFunction().getName() + ": " + vecInfo.getRegion().str()).str(); })
+  {}
+};
+
 VectorizerInterface::VectorizerInterface(PlatformInfo & _platInfo, Config _config)
         : config(_config)
         , platInfo(_platInfo)
@@ -82,6 +99,7 @@ EmbedInlinedCode(BasicBlock & entry, Loop & hostLoop, LoopInfo & loopInfo, std::
 void
 VectorizerInterface::lowerRuntimeCalls(VectorizationInfo & vecInfo, FunctionAnalysisManager & FAM)
 {
+  PhaseTimer phaseTimer("lowerRuntimeCalls", vecInfo, config);
   auto & scalarFn = vecInfo.getScalarFunction();
   auto & mod = *scalarFn.getParent();
 
@@ -158,10 +176,21 @@ VectorizerInterface::analyze(VectorizationInfo& vecInfo,
     }
 
     // determines value and control shapes
+    PhaseTimer phaseTimer("VectorizationAnalysis", vecInfo, config);
     VectorizationAnalysis vea(config, platInfo, vecInfo, FAM);
     vea.analyze();
 }
 
+void
+VectorizerInterface::updateAnalysis(VectorizationInfo& vecInfo,
+                                    FunctionAnalysisManager& FAM,
+                                    const std::vector<const Instruction*> & updateList)
+{
+    PhaseTimer phaseTimer("UpdateAnalysis", vecInfo, config);
+    VectorizationAnalysis vea(config, platInfo, vecInfo, FAM);
+    vea.updateAnalysis(updateList);
+}
+
 bool
 VectorizerInterface::linearize(VectorizationInfo& vecInfo,
                  FunctionAnalysisManager & FAM) {
@@ -169,12 +198,13 @@ VectorizerInterface::linearize(VectorizationInfo& vecInfo,
     // TODO make this part of a new optimization phase
     // Scalar-Replication-Of-Varying-(Aggregates): split up structs of vectorizable elements to promote use of vector registers
     if (config.enableSROV) {
+      PhaseTimer phaseTimer("SROV", vecInfo, config);
       SROVTransform srovTransform(vecInfo, platInfo);
       bool Changed = srovTransform.run();
       while (Changed) {
-        // re-run DA
-        vecInfo.forgetInferredProperties();
-        analyze(vecInfo, FAM);
+        // update the DA from the instructions created by SROV
+        VectorizationAnalysis vea(config, platInfo, vecInfo, FAM);
+        vea.reanalyze(srovTransform.getUpdateList());
 
         // re-run SROV
         Changed = srovTransform.run();
@@ -184,8 +214,11 @@ VectorizerInterface::linearize(VectorizationInfo& vecInfo,
     }
   
     // early lowering of divergent switch statements
-    LowerDivergentSwitches divSwitchTrans(vecInfo, FAM);
-    divSwitchTrans.run();
+    {
+      PhaseTimer phaseTimer("LowerDivergentSwitches", vecInfo, config);
+      LowerDivergentSwitches divSwitchTrans(vecInfo, FAM);
+      divSwitchTrans.run();
+    }
 
     // FIXME materialize masks only very late in the process (risk of mask invalidation through transformations)
     MaskExpander maskEx(vecInfo, FAM);
@@ -193,27 +226,35 @@ VectorizerInterface::linearize(VectorizationInfo& vecInfo,
     // convert divergent loops inside the region to uniform loops
     if (CheckFlag("RV_OLD_DLT")) {
       Report() << "Using old DLT\n";
+      PhaseTimer phaseTimer("DivLoopTrans", vecInfo, config);
       DivLoopTrans DLT(platInfo, vecInfo, maskEx, FAM);
       DLT.transformDivergentLoops();
     } else {
       Report() << "Using new (guarded) DLT\n";
+      PhaseTimer phaseTimer("GuardedDivLoopTrans", vecInfo, config);
       GuardedDivLoopTrans guardedDLT(platInfo, vecInfo, maskEx, FAM);
       guardedDLT.transformDivergentLoops();
     }
 
+    // lane profile feedback (RV_LANE_PROFILE_USE) enables CIF/BOSCC on the profiled branches
+    bool hasLaneProfile = LaneProfile::getProfile();
+
     // insert CIF branches if desired
-    if (config.enableCoherentIF) {
-      CoherentIFTransform CoherentIFTrans(vecInfo, platInfo, maskEx, FAM);
+    if (config.enableCoherentIF || hasLaneProfile) {
+      CoherentIFTransform CoherentIFTrans(vecInfo, platInfo, maskEx, FAM, config.enableCoherentIF);
       CoherentIFTrans.run();
     }
 
     // insert BOSCC branches if desired
-    if (config.enableHeuristicBOSCC) {
-      BOSCCTransform bosccTrans(vecInfo, platInfo, maskEx, FAM);
+    if (config.enableHeuristicBOSCC || hasLaneProfile) {
+      BOSCCTransform bosccTrans(vecInfo, platInfo, maskEx, FAM, config.enableHeuristicBOSCC);
       bosccTrans.run();
     }
     // expand masks after BOSCC
-    maskEx.expandRegionMasks();
+    {
+      PhaseTimer phaseTimer("MaskExpander", vecInfo, config);
+      maskEx.expandRegionMasks();
+    }
 
     IF_DEBUG {
       errs() << "--- VecInfo before Linearizer ---\n";
@@ -231,8 +272,11 @@ VectorizerInterface::linearize(VectorizationInfo& vecInfo,
     redOpt.run();
 
     // partially linearize acyclic control in the region
-    Linearizer linearizer(config, vecInfo, maskEx, FAM);
-    linearizer.run();
+    {
+      PhaseTimer phaseTimer("Linearizer", vecInfo, config);
+      Linearizer linearizer(config, vecInfo, maskEx, FAM);
+      linearizer.run();
+    }
 
     IF_DEBUG {
       errs() << "--- VecInfo after Linearizer ---\n";
@@ -273,11 +317,15 @@ VectorizerInterface::vectorize(VectorizationInfo &vecInfo, FunctionAnalysisManag
   if (hostLoop) reda.analyze(*hostLoop);
 
 // vectorize with native
-  NatBuilder natBuilder(config, platInfo, vecInfo, reda, FAM);
-  natBuilder.vectorize(true, vecInstMap);
+  {
+    PhaseTimer phaseTimer("NatBuilder", vecInfo, config);
+    NatBuilder natBuilder(config, platInfo, vecInfo, reda, FAM);
+    natBuilder.vectorize(true, vecInstMap);
+  }
 
   // IR Polish phase: promote i1 vectors and perform early instruction (read: intrinsic) selection
   if (config.enableIRPolish) {
+    PhaseTimer phaseTimer("IRPolisher", vecInfo, config);
     IRPolisher polisher(vecInfo.getVectorFunction(), config);
     polisher.polish();
     Report() << "IR Polisher enabled (RV_ENABLE_POLISH != 0)\n";
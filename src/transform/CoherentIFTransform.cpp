@@ -9,6 +9,7 @@
 
 #include "rv/transform/CoherentIFTransform.h"
 #include "rv/analysis/BranchEstimate.h"
+#include "rv/analysis/LaneProfile.h"
 
 #include <vector>
 #include <sstream>
@@ -67,8 +68,10 @@ struct CoherentIF{
   Module & mod;
   BranchProbabilityInfo *pbInfo;
   BranchEstimate BranchEst;
+  bool useHeuristics;
+  const LaneProfile * laneProfile;
 
-CoherentIF(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo,  MaskExpander & _maskEx, DominatorTree & _domTree, PostDominatorTree & _postDomTree, LoopInfo & _loopInfo, BranchProbabilityInfo * _pbInfo)
+CoherentIF(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo,  MaskExpander & _maskEx, DominatorTree & _domTree, PostDominatorTree & _postDomTree, LoopInfo & _loopInfo, BranchProbabilityInfo * _pbInfo, bool _useHeuristics)
 : vecInfo(_vecInfo)
 , platInfo(_platInfo)
 , maskEx(_maskEx)
@@ -78,6 +81,8 @@ CoherentIF(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo,  MaskExpander
 , mod(*vecInfo.getScalarFunction().getParent())
 , pbInfo(_pbInfo)
 , BranchEst(vecInfo, platInfo, maskEx, domTree, loopInfo, pbInfo)
+, useHeuristics(_useHeuristics)
+, laneProfile(LaneProfile::getProfile())
 {}
 
 void MaintainCloneLoopwithHeader (Loop * clonedParentLoop, Loop & L, ValueToValueMapTy & valueMap) {
@@ -429,6 +434,16 @@ IsAffine (Instruction* instruction)
 // currently only cope with BOSCC and CIF
 int
 PickSuccessorForCIF(BranchInst & branch, bool onTrueLegal, bool onFalseLegal) {
+  // profile-guided decision: a coherent branch sends all or no lanes to a successor
+  const double maxMixedRatio = GetValue<double>("CIF_PROFILE_T", 0.40);
+  auto getCoherenceScore = [&](const LaneStats * stats) { return maxMixedRatio - (stats ? stats->getMixedRatio() : 1.0); };
+  int profileDecision;
+  if (laneProfile && laneProfile->pickSuccessor(branch, vecInfo.getMapping().vectorFn->getName(), onTrueLegal, onFalseLegal, getCoherenceScore, profileDecision)) {
+    IF_DEBUG_CIF { errs() << "CIF: profiled decision " << profileDecision << ", CIF_PROFILE_T=" << maxMixedRatio << "\n"; }
+    return profileDecision;
+  }
+  if (!useHeuristics) return 0;
+
   double trueRatio = 0.0;
   double falseRatio = 0.0;
   size_t onTrueScore = 0;
@@ -500,7 +515,7 @@ run() {
 
 
     // if affine fails, then use high probability
-    if (IsAffine(dyn_cast<Instruction>(branchCond))) {
+    if (useHeuristics && IsAffine(dyn_cast<Instruction>(branchCond))) {
       IF_DEBUG_CIF {errs()<< *branchCond << " is affine condition" << "\n";}
       ++numCIFBranches;
       transformCoherentCF(*branchInst, 0);
@@ -538,11 +553,11 @@ run() {
 
 bool
 CoherentIFTransform::run() {
-  CoherentIF coherentif(vecInfo, platInfo, maskEx, domTree, postDomTree, loopInfo, pbInfo);
+  CoherentIF coherentif(vecInfo, platInfo, maskEx, domTree, postDomTree, loopInfo, pbInfo, useHeuristics);
   return coherentif.run();
 }
 
-CoherentIFTransform::CoherentIFTransform (VectorizationInfo & _vecInfo, PlatformInfo & _platInfo, MaskExpander & _maskEx, llvm::FunctionAnalysisManager &FAM)
+CoherentIFTransform::CoherentIFTransform (VectorizationInfo & _vecInfo, PlatformInfo & _platInfo, MaskExpander & _maskEx, llvm::FunctionAnalysisManager &FAM, bool _useHeuristics)
 : vecInfo(_vecInfo)
 , platInfo(_platInfo)
 , maskEx(_maskEx)
@@ -550,4 +565,5 @@ CoherentIFTransform::CoherentIFTransform (VectorizationInfo & _vecInfo, Platform
 , postDomTree(FAM.getResult<PostDominatorTreeAnalysis>(vecInfo.getScalarFunction()))
 , loopInfo(*FAM.getCachedResult<LoopAnalysis>(vecInfo.getScalarFunction()))
 , pbInfo(&FAM.getResult<BranchProbabilityAnalysis>(vecInfo.getScalarFunction()))
+, useHeuristics(_useHeuristics)
 {}
@@ -1342,6 +1342,16 @@ Linearizer::run() {
       ReportContinue() << "\t" << numRedundantIncomingValues << " redundant incoming folds.\n";
     }
   }
+
+  // record for the per-region statistics dump
+  vecInfo.addRegionStatistic("FoldedBranches", numFoldedBranches);
+  vecInfo.addRegionStatistic("PreservedBranches", numPreservedBranches);
+  vecInfo.addRegionStatistic("DivertedHeads", numDivertedHeads);
+  vecInfo.addRegionStatistic("ControlUniformPhis", numCUniPhis);
+  vecInfo.addRegionStatistic("ControlDivergentPhis", numCDivPhis);
+  vecInfo.addRegionStatistic("FoldedIncomingValues", numFoldedAssignments);
+  vecInfo.addRegionStatistic("Blends", numBlends);
+  vecInfo.addRegionStatistic("SimplifiedBlends", numSimplifiedBlends);
 }
 
 void
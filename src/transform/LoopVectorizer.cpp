@@ -19,9 +19,12 @@
 #include "rv/region/Region.h"
 #include "rv/resolver/resolvers.h"
 #include "rv/analysis/loopAnnotations.h"
+#include "rv/annotations.h"
 #include "rv/analysis/reductionAnalysis.h"
 #include "rv/analysis/costModel.h"
+#include "rv/analysis/PlatformInfoAnalysis.h"
 #include "rv/transform/remTransform.h"
+#include "rv/transform/loopVersioning.h"
 
 #include "rv/config.h"
 #include "rvConfig.h"
@@ -40,8 +43,10 @@
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
 
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Support/MathExtras.h"
 
 #include "report.h"
 #include <map>
@@ -49,6 +54,14 @@
 using namespace rv;
 using namespace llvm;
 
+// optimization remarks (-Rpass=rv-loop-vectorize, -fsave-optimization-record)
+static const char * RemarkPassName = "rv-loop-vectorize";
+
+static OptimizationRemarkMissed
+MissedRemark(Loop & L, StringRef reasonCode) {
+  return OptimizationRemarkMissed(RemarkPassName, reasonCode, L.getStartLoc(), L.getHeader());
+}
+
 // typedef DomTreeNodeBase<BasicBlock*> DomTreeNode;
 
 
@@ -106,14 +119,48 @@ LoopVectorizer::transformToVectorizableLoop(Loop &L, int VectorWidth, int tripAl
   return preparedLoop;
 }
 
+// number of reduction chains carried by @L
+static
+size_t
+CountReductionChains(Loop & L, ReductionAnalysis & reda) {
+  size_t numChains = 0;
+  for (auto & inst : *L.getHeader()) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) break;
+    auto * redInfo = reda.getReductionInfo(*phi);
+    if (redInfo && redInfo->kind != RedKind::Top && redInfo->kind != RedKind::Bot) ++numChains;
+  }
+  return numChains;
+}
+
+// whether any header phi of @L carries a prefix scan, a paired reduction or a compaction index (their latch values can not be blended)
+static
+bool
+HasInOrderRecurrence(Loop & L, ReductionAnalysis & reda) {
+  for (auto & inst : *L.getHeader()) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) break;
+    auto * redInfo = reda.getReductionInfo(*phi);
+    if (redInfo && (redInfo->isScan || redInfo->isPayload || redInfo->isCompact)) return true;
+  }
+  return false;
+}
+
 static
 bool
-IsSupportedReduction(Loop & L, Reduction & red) {
+IsSupportedReduction(Loop & L, Reduction & red, ReductionAnalysis & reda) {
+  // the in-loop users of scans and compaction indices read the running value (checked by the ReductionAnalysis)
+  if (red.isScan || red.isCompact) return true;
+
   // check that all users of the reduction are either (a) part of it or (b) outside the loop
   for (auto * inst : red.elements) {
     for (auto itUser : inst->users()) {
       auto * userInst = dyn_cast<Instruction>(itUser);
       if (!userInst) return false; // unsupported
+      // the payload of a paired reduction selects on the key condition
+      auto * userRed = reda.getReductionInfo(*userInst);
+      if (userRed && userRed->isPayload && userRed->keyRed == &red) continue;
+
       if (L.contains(userInst->getParent()) &&
         !red.elements.count(userInst))  {
         errs() << "Unsupported user of reduction: "; Dump(*userInst); 
@@ -125,6 +172,98 @@ IsSupportedReduction(Loop & L, Reduction & red) {
   return true;
 }
 
+bool
+LoopVectorizer::analyzeTrialLoop(Loop &L, VectorizationInfo & trialInfo) {
+  size_t width = trialInfo.getVectorWidth();
+
+  // header phi shapes (as they will be set up for the prepared loop)
+  for (auto & inst : *L.getHeader()) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) continue;
+
+    VectorShape phiShape;
+    if (auto * pat = reda->getStrideInfo(*phi)) {
+      phiShape = pat->getShape(width);
+    } else if (auto * redInfo = reda->getReductionInfo(*phi)) {
+      if (redInfo->kind == RedKind::Top || (redInfo->kind == RedKind::Bot && !redInfo->isPayload)) return false;
+      phiShape = redInfo->getShape(width);
+    } else {
+      // not vectorizable anyway (reported later)
+      return false;
+    }
+    if (phiShape.isDefined()) trialInfo.setPinnedShape(*phi, phiShape);
+  }
+
+  // the remainder transformation makes the loop exits uniform
+  SmallVector<BasicBlock*, 2> exitingBlocks;
+  L.getExitingBlocks(exitingBlocks);
+  for (auto * exitingBlock : exitingBlocks) {
+    trialInfo.setPinnedShape(*exitingBlock->getTerminator(), VectorShape::uni());
+  }
+
+  vectorizer->analyze(trialInfo, FAM);
+  return true;
+}
+
+size_t
+LoopVectorizer::pickWidthByCost(Loop &L, size_t maxWidth) {
+  CostModel costModel(vectorizer->getPlatformInfo(), config);
+  LoopRegion trialLoopRegionImpl(L);
+  Region trialLoopRegion(trialLoopRegionImpl);
+
+  double scalarCost = costModel.estimateScalarCost(trialLoopRegion, F->getName());
+  size_t bestWidth = 1;
+  double bestLaneCost = scalarCost;
+
+  for (size_t width = 2; width <= maxWidth; width *= 2) {
+    VectorizationInfo trialInfo(*F, width, trialLoopRegion);
+    if (!analyzeTrialLoop(L, trialInfo)) return maxWidth;
+
+    double laneCost = costModel.estimateVectorCost(trialInfo) / width;
+
+    if (enableDiagOutput) {
+      Report() << "loopVecPass, costModel: width " << width << " costs " << laneCost
+               << " per iteration (scalar: " << scalarCost << ")\n";
+    }
+
+    if (laneCost < bestLaneCost) {
+      bestLaneCost = laneCost;
+      bestWidth = width;
+    }
+  }
+
+  return bestWidth;
+}
+
+RemainderMode
+LoopVectorizer::pickRemainderMode(Loop &L, int VectorWidth, int tripCount) {
+  // no remainder iterations
+  if (tripCount > 0 && tripCount % VectorWidth == 0) return RemainderMode::Scalar;
+
+  CostModel costModel(vectorizer->getPlatformInfo(), config);
+  LoopRegion trialLoopRegionImpl(L);
+  Region trialLoopRegion(trialLoopRegionImpl);
+  VectorizationInfo trialInfo(*F, VectorWidth, trialLoopRegion);
+  if (!analyzeTrialLoop(L, trialInfo)) return RemainderMode::Scalar;
+
+  // expected number of remainder iterations
+  double numRemIters = tripCount > 0 ? (tripCount % VectorWidth) : (VectorWidth - 1) / 2.0;
+  double scalarRemCost = numRemIters * costModel.estimateScalarCost(trialLoopRegion, F->getName());
+  double maskedRemCost = costModel.estimateVectorCost(trialInfo, true);
+
+  if (enableDiagOutput) {
+    Report() << "loopVecPass, costModel: scalar remainder costs " << scalarRemCost
+             << ", masked remainder costs " << maskedRemCost << "\n";
+  }
+
+  if (maskedRemCost >= scalarRemCost) return RemainderMode::Scalar;
+
+  // there is no full vector of iterations
+  if (tripCount > 0 && tripCount < VectorWidth) return RemainderMode::Predicated;
+
+  return RemainderMode::MaskedEpilogue;
+}
+
 bool
 LoopVectorizer::vectorizeLoop(Loop &L) {
 // check the dependence distance of this loop
@@ -135,6 +274,7 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
   // only trigger on annotated loops
   if (!mdAnnot.vectorizeEnable.safeGet(false)) {
     if (enableDiagOutput) Report() << "loopVecPass skip " << L.getName() << " . not explicitly triggered.\n";
+    ORE->emit([&]() { return MissedRemark(L, "NotTriggered") << "loop is not annotated for vectorization"; });
     return false;
   }
 
@@ -150,6 +290,7 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
   // skip if iteration dependence distance precludes vectorization
   if (depDist <= 1) {
     if (enableDiagOutput) Report() << "loopVecPass skip " << L.getName() << " . Min dependence distance was " << depDist << "\n";
+    ORE->emit([&]() { return MissedRemark(L, "DependenceDistance") << "minimal dependence distance is " << ore::NV("DepDist", depDist); });
     return false;
   }
 
@@ -167,6 +308,10 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
     if (enableDiagOutput) Report() << "loopVecPass: with user-provided vector width (RV_FORCE_WIDTH=" << VectorWidth << ")\n";
   }
 
+// analyze the recurrsnce patterns of this loop
+  reda.reset(new ReductionAnalysis(*F, FAM));
+  reda->analyze(L);
+
 // pick a vectorization factor (unless user override is set)
   if (!hasFixedWidth) {
     size_t initialWidth = VectorWidth == 0 ? depDist : VectorWidth;
@@ -174,10 +319,14 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
     CostModel costModel(vectorizer->getPlatformInfo(), config);
     LoopRegion tmpLoopRegionImpl(L);
     Region tmpLoopRegion(tmpLoopRegionImpl);
-    size_t refinedWidth = costModel.pickWidthForRegion(tmpLoopRegion, initialWidth); // TODO run VA first
+    size_t refinedWidth = costModel.pickWidthForRegion(tmpLoopRegion, initialWidth);
+
+    // compare the throughput of all remaining widths (after the VA)
+    if (refinedWidth > 1) refinedWidth = pickWidthByCost(L, refinedWidth);
 
     if (refinedWidth <= 1) {
       if (enableDiagOutput) { Report() << "loopVecPass, costModel: vectorization not beneficial\n"; }
+      ORE->emit([&]() { return MissedRemark(L, "NotBeneficial") << "cost model: vectorization not beneficial"; });
       return false;
     } else if (refinedWidth != (size_t) VectorWidth) {
       if (enableDiagOutput) {
@@ -185,34 +334,144 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
         if (VectorWidth > 1) Report() << VectorWidth << "\n";
         else ReportContinue() << " unbounded\n";
       }
+      ORE->emit([&]() {
+        return OptimizationRemarkAnalysis(RemarkPassName, "WidthRefined", L.getStartLoc(), L.getHeader())
+               << "cost model: refined vector width to " << ore::NV("VectorWidth", refinedWidth)
+               << " (dependence distance " << ore::NV("DepDist", DepDistToString(depDist)) << ")";
+      });
       VectorWidth = refinedWidth;
     }
   }
 
+// interleave vector iterations: the backend splits the wider values into independent registers (and reduction accumulators)
+  iter_t interleaveCount = 1;
+  if (mdAnnot.interleaveCount.isSet()) {
+    interleaveCount = std::max<iter_t>(1, mdAnnot.interleaveCount.get());
+  } else if (config.enableLoopInterleaving) {
+    CostModel costModel(vectorizer->getPlatformInfo(), config);
+    LoopRegion tmpLoopRegionImpl(L);
+    Region tmpLoopRegion(tmpLoopRegionImpl);
+    interleaveCount = costModel.pickInterleaveCount(tmpLoopRegion, VectorWidth, CountReductionChains(L, *reda));
+  }
+  interleaveCount = PowerOf2Floor(interleaveCount);
+
+  // do not exceed the dependence distance or the trip count
+  int loopTripCount = getTripCount(L);
+  while (interleaveCount > 1 &&
+         (interleaveCount * VectorWidth > depDist || (loopTripCount > 0 && interleaveCount * VectorWidth > loopTripCount))) {
+    interleaveCount /= 2;
+  }
+  if (interleaveCount > 1) {
+    Report() << "loopVecPass: interleaving " << interleaveCount << " vector iterations of width " << VectorWidth << "\n";
+    VectorWidth *= interleaveCount;
+  }
+
   Report() << "loopVecPass: Vectorize " << L.getName()
            << " with VW: " << VectorWidth
            << " , Dependence Distance: " << DepDistToString(depDist)
            << " and TripAlignment: " << tripAlign << "\n";
 
-// analyze the recurrsnce patterns of this loop
-  reda.reset(new ReductionAnalysis(*F, FAM));
-  reda->analyze(L);
+// pick the remainder strategy (annotation or cost model)
+  RemainderMode remMode = RemainderMode::Scalar;
+  if (mdAnnot.remainderMode.isSet()) {
+    remMode = mdAnnot.remainderMode.get();
+  } else if (config.enableMaskedRemainder) {
+    remMode = pickRemainderMode(L, VectorWidth, getTripCount(L));
+  }
+
+  // the remainder loop would never execute
+  if (remMode == RemainderMode::MaskedEpilogue && tripAlign % VectorWidth == 0) {
+    remMode = RemainderMode::Scalar;
+  }
+
+  // the running value of scans is not blended in predicated loops
+  if (remMode != RemainderMode::Scalar && HasInOrderRecurrence(L, *reda)) {
+    Report() << "loopVecPass: scans and paired reductions require a scalar remainder\n";
+    remMode = RemainderMode::Scalar;
+  }
+
+  if (remMode != RemainderMode::Scalar) {
+    Report() << "loopVecPass: using a " << to_string(remMode) << " remainder\n";
+  }
+
+// check the recurrences before the loop is transformed (the predicated loop replaces the scalar loop)
+  ReductionMode redMode = mdAnnot.reductionMode.safeGet(ReductionMode::Auto);
+  if (!checkHeaderPhis(L, L, redMode)) {
+    return false;
+  }
+
+// runtime overlap checks for loops that are not annotated as parallel
+  LoopVersioningTransform versioning(*F, *DT, *PDT, *LI, *SE, PB);
+  bool needsOverlapChecks = false;
+  if (config.enableLoopVersioning && !L.isAnnotatedParallel()) {
+    if (!versioning.analyzeOverlapChecks(L, VectorWidth)) {
+      Report() << "loopVecPass skip " << L.getName() << " . can not check memory accesses at runtime.\n";
+      ORE->emit([&]() { return MissedRemark(L, "NoRuntimeChecks") << "can not check memory accesses at runtime"; });
+      return false;
+    }
+    needsOverlapChecks = versioning.needsOverlapChecks();
+
+    // the scalar loop is the fallback if the checks fail
+    if (needsOverlapChecks) {
+      remMode = RemainderMode::Scalar;
+      tripAlign = 1;
+    }
+  }
+
+  // peel iterations to align the main access of the vector loop
+  int tripCount = getTripCount(L);
+  if (config.enableLoopVersioning && remMode != RemainderMode::Predicated &&
+      (tripCount < 0 || tripCount >= 2 * VectorWidth)) {
+    if (versioning.peelForAlignment(L, VectorWidth)) {
+      Report() << "loopVecPass: peeled " << L.getName() << " for alignment\n";
+      tripAlign = 1;
+      reda->analyze(L);
+    }
+  }
 
 // match vector loop structure
   ValueSet uniOverrides;
-  auto * PreparedLoop = transformToVectorizableLoop(L, VectorWidth, tripAlign, uniOverrides);
+  Loop * PreparedLoop = nullptr;
+  if (remMode == RemainderMode::Predicated) {
+    RemainderTransform remTrans(*F, *DT, *PDT, *LI, *reda, PB);
+    PreparedLoop = remTrans.createPredicatedLoop(L, uniOverrides, VectorWidth);
+    if (!PreparedLoop) {
+      Report() << "loopVecPass: Can not predicate the loop, falling back to a scalar remainder\n";
+      remMode = RemainderMode::Scalar;
+    }
+  }
+
+  if (!PreparedLoop) {
+    PreparedLoop = transformToVectorizableLoop(L, VectorWidth, tripAlign, uniOverrides);
+  }
   if (!PreparedLoop) {
     Report() << "loopVecPass: Can not prepare vectorization of the loop\n";
+    ORE->emit([&]() { return MissedRemark(L, "CanNotPrepare") << "can not transform the loop into a vectorizable form"; });
     return false;
   }
 
-  // mark the remainder loop as un-vectorizable
-  LoopMD llvmLoopMD;
-  llvmLoopMD.alreadyVectorized = true;
-  SetLLVMLoopAnnotations(L, std::move(llvmLoopMD));
+  if (needsOverlapChecks) {
+    assert(PreparedLoop != &L && "no vector loop guard for the overlap checks");
+    versioning.insertOverlapChecks(*PreparedLoop->getLoopPreheader(), *PreparedLoop->getHeader());
+  }
 
-  // clear loop annotations from our copy of the lop
-  ClearLoopVectorizeAnnotations(*PreparedLoop);
+  // run the remainder iterations as one predicated vector iteration
+  ValueSet epilogueUniOverrides;
+  Loop * EpilogueLoop = nullptr;
+  if (remMode == RemainderMode::MaskedEpilogue) {
+    RemainderTransform remTrans(*F, *DT, *PDT, *LI, *reda, PB);
+    EpilogueLoop = remTrans.createPredicatedLoop(L, epilogueUniOverrides, VectorWidth);
+    if (!EpilogueLoop) {
+      Report() << "loopVecPass: Can not predicate the remainder loop, falling back to a scalar remainder\n";
+    }
+  }
+
+  // mark the (scalar) remainder loop as un-vectorizable
+  if (PreparedLoop != &L && !EpilogueLoop) {
+    LoopMD llvmLoopMD;
+    llvmLoopMD.alreadyVectorized = true;
+    SetLLVMLoopAnnotations(L, std::move(llvmLoopMD));
+  }
 
   // print configuration banner once
   if (!introduced) {
@@ -221,18 +480,105 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
     introduced = true;
   }
 
+  if (!vectorizePreparedLoop(L, *PreparedLoop, VectorWidth, uniOverrides, redMode)) {
+    // the scalar loop itself has been predicated
+    if (PreparedLoop == &L) fail("loopVecPass: the predicated loop " + L.getName().str() + " can not be vectorized");
+    return false;
+  }
+
+  // the scalar loop itself has been predicated as the remainder
+  if (EpilogueLoop) {
+    IF_DEBUG { errs() << "rv: Vectorizing the remainder loop of " << L.getName() << "\n"; }
+    if (!vectorizePreparedLoop(L, *EpilogueLoop, VectorWidth, epilogueUniOverrides, redMode)) {
+      fail("loopVecPass: the predicated remainder of " + L.getName().str() + " can not be vectorized");
+    }
+  }
+
+  ORE->emit([&]() {
+    return OptimizationRemark(RemarkPassName, "Vectorized", L.getStartLoc(), L.getHeader())
+           << "vectorized loop (vector width: " << ore::NV("VectorWidth", VectorWidth)
+           << ", interleave count: " << ore::NV("InterleaveCount", interleaveCount)
+           << ", remainder: " << ore::NV("Remainder", to_string(remMode)) << ")";
+  });
+
+  return true;
+}
+
+// whether all header phis of @CheckLoop (@L or its prepared version) are vectorizable recurrences.
+// this has to hold before @L is transformed: a loop that was predicated in place can not be left scalar.
+bool
+LoopVectorizer::checkHeaderPhis(Loop &L, Loop &CheckLoop, ReductionMode redMode) {
+  for (auto & inst : *CheckLoop.getHeader()) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) continue;
+    if (reda->getStrideInfo(*phi)) continue;
+
+    rv::Reduction * redInfo = reda->getReductionInfo(*phi);
+
+    // failure to derive a reduction descriptor
+    if (!redInfo) {
+      Report() << "\n\tskip: unrecognized phi use in vector loop " << L.getName() << "\n";
+      ORE->emit([&]() { return MissedRemark(L, "UnrecognizedPhi") << "unrecognized recurrence " << ore::NV("Phi", phi); });
+      return false;
+    }
+
+    if (!IsSupportedReduction(CheckLoop, *redInfo, *reda)) {
+      Report() << " unsupported reduction: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
+      ORE->emit([&]() { return MissedRemark(L, "UnsupportedReduction") << "reduction " << ore::NV("Phi", phi) << " has users in the loop"; });
+      return false;
+    }
+
+    // unsupported reduction kind
+    if (redInfo->kind == RedKind::Top) {
+      Report() << " can not vectorize this non-trivial SCC: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
+      ORE->emit([&]() { return MissedRemark(L, "UnknownReduction") << "unrecognized reduction operator in " << ore::NV("Phi", phi); });
+      return false;
+    }
+
+    // FIXME rv codegen only supports trivial recurrences at the moment
+    if (redInfo->kind == RedKind::Bot && !redInfo->isPayload) {
+      Report() << " can not vectorize this non-affine recurrence: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
+      ORE->emit([&]() { return MissedRemark(L, "NonAffineRecurrence") << "non-affine recurrence " << ore::NV("Phi", phi); });
+      return false;
+    }
+
+    // in-vector scans reassociate the running value
+    bool isOrdered = redMode == ReductionMode::Ordered || (redMode == ReductionMode::Auto && CheckFlag("RV_RED_ORDER"));
+    if (redInfo->isScan && isOrdered && phi->getType()->isFloatingPointTy()) {
+      Report() << " can not vectorize this scan in order: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
+      ORE->emit([&]() { return MissedRemark(L, "OrderedScan") << "floating-point scan " << ore::NV("Phi", phi) << " must stay in order"; });
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+LoopVectorizer::vectorizePreparedLoop(Loop &L, Loop &PreparedLoop, int VectorWidth, ValueSet & uniOverrides, ReductionMode redMode) {
+  // clear loop annotations from our copy of the lop
+  ClearLoopVectorizeAnnotations(PreparedLoop);
+
+  // recurrences of the prepared loop
+  reda->analyze(PreparedLoop);
+
 // start vectorizing the prepared loop
   IF_DEBUG { errs() << "rv: Vectorizing loop " << L.getName() << "\n"; }
 
   VectorMapping targetMapping(F, F, VectorWidth, CallPredicateMode::SafeWithoutPredicate);
-  LoopRegion LoopRegionImpl(*PreparedLoop);
+  LoopRegion LoopRegionImpl(PreparedLoop);
   Region LoopRegion(LoopRegionImpl);
 
   VectorizationInfo vecInfo(*F, VectorWidth, LoopRegion);
 
 // Check reduction patterns of vector loop phis
+  // the scalar loop @L passed the same checks before it was transformed
+  if (!checkHeaderPhis(L, PreparedLoop, redMode)) {
+    return false;
+  }
+
   // configure initial shape for induction variable
-  for (auto & inst : *PreparedLoop->getHeader()) {
+  for (auto & inst : *PreparedLoop.getHeader()) {
     auto * phi = dyn_cast<PHINode>(&inst);
     if (!phi) continue;
 
@@ -245,32 +591,12 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
       rv::Reduction * redInfo = reda->getReductionInfo(*phi);
       IF_DEBUG { errs() << "loopVecPass: header phi  " << *phi << " : "; }
 
-      // failure to derive a reduction descriptor
-      if (!redInfo) {
-        Report() << "\n\tskip: unrecognized phi use in vector loop " << L.getName() << "\n";
-        return false;
-      }
-
-      if (!IsSupportedReduction(*PreparedLoop, *redInfo)) {
-        Report() << " unsupported reduction: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
-        return false;
-      }
-
-      // unsupported reduction kind
-      if (redInfo->kind == RedKind::Top) {
-        Report() << " can not vectorize this non-trivial SCC: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
-        return false;
-      }
-
-      // FIXME rv codegen only supports trivial recurrences at the moment
-      if (redInfo->kind == RedKind::Bot) {
-        Report() << " can not vectorize this non-affine recurrence: "; redInfo->print(ReportContinue()); ReportContinue() << "\n";
-        return false;
-      }
-
-      // Otw, this is a privatizable reduction pattern
+      // a privatizable reduction pattern (checked by checkHeaderPhis)
       IF_DEBUG { redInfo->dump(); }
       phiShape = redInfo->getShape(VectorWidth);
+
+      // tell the backend how to finalize this reduction
+      if (redMode != ReductionMode::Auto) SetReductionModeHint(*phi, redMode);
     }
 
     IF_DEBUG { errs() << "header phi " << phi->getName() << " has shape " << phiShape.str() << "\n"; }
@@ -312,7 +638,7 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
   }
 
   IF_DEBUG Dump(*F);
-  assert(L.getLoopPreheader());
+  assert(PreparedLoop.getLoopPreheader());
 
   // control conversion
   vectorizer->linearize(vecInfo, FAM);
@@ -333,7 +659,7 @@ LoopVectorizer::vectorizeLoop(Loop &L) {
 
   if (enableDiagOutput) {
     errs() << "-- Vectorized --\n";
-    for (const BasicBlock * BB : PreparedLoop->blocks()) {
+    for (const BasicBlock * BB : PreparedLoop.blocks()) {
       const BasicBlock * vecB = cast<const BasicBlock>(vecMap[BB]);
       Dump(*vecB);
     }
@@ -385,22 +711,14 @@ bool LoopVectorizer::runOnFunction(Function &F) {
   this->SE = &FAM.getResult<ScalarEvolutionAnalysis>(F);
   this->MDR = &FAM.getResult<MemoryDependenceAnalysis>(F);
   this->PB = &FAM.getResult<BranchProbabilityAnalysis>(F);
+  this->ORE = &FAM.getResult<OptimizationRemarkEmitterAnalysis>(F);
   TargetTransformInfo & tti = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(F); // FIXME use FAM
   TargetLibraryInfo & tli = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F); // FIXME use FAM
 
   this->config = Config::createForFunction(F);
 
-// setup PlatformInfo
-  PlatformInfo platInfo(*F.getParent(), &tti, &tli);
-
-  // TODO translate fast-math flag to ULP error bound
-  if (!CheckFlag("RV_NO_SLEEF")) { addSleefResolver(config, platInfo); }
-
-  // enable inter-procedural vectorization
-  if (config.enableGreedyIPV) {
-    Report() << "Using greedy inter-procedural vectorization.\n";
-    addRecursiveResolver(config, platInfo);
-  }
+// setup PlatformInfo (shared by all functions of the module)
+  PlatformInfo & platInfo = getAnalysis<PlatformInfoWrapperPass>().getPlatformInfo(F, tti, tli, config);
 
   vectorizer.reset(new VectorizerInterface(platInfo, config));
 
@@ -424,6 +742,7 @@ bool LoopVectorizer::runOnFunction(Function &F) {
   this->SE = nullptr;
   this->MDR = nullptr;
   this->PB = nullptr;
+  this->ORE = nullptr;
   return Changed;
 }
 
@@ -438,6 +757,7 @@ void LoopVectorizer::getAnalysisUsage(AnalysisUsage &AU) const {
   // PlatformInfo
   AU.addRequired<TargetTransformInfoWrapperPass>();
   AU.addRequired<TargetLibraryInfoWrapperPass>();
+  AU.addRequired<PlatformInfoWrapperPass>();
 }
 
 char LoopVectorizer::ID = 0;
@@ -455,5 +775,6 @@ INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
 // PlatformInfo
 INITIALIZE_PASS_DEPENDENCY(TargetTransformInfoWrapperPass)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(PlatformInfoWrapperPass)
 INITIALIZE_PASS_END(LoopVectorizer, "rv-loop-vectorize", "RV - Vectorize loops",
                     false, false)
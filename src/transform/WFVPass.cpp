@@ -24,6 +24,7 @@
 #include "rvConfig.h"
 #include "rv/rvDebug.h"
 #include "rv/region/FunctionRegion.h"
+#include "rv/vectorizationInfo.h"
 
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
@@ -42,11 +43,19 @@
 
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/ADT/Sequence.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include "report.h"
 #include <map>
 #include <sstream>
 #include <cassert>
+#include <cstdlib>
+#include <numeric>
 
 using namespace rv;
 using namespace llvm;
@@ -61,14 +70,79 @@ WFVPass::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<TargetLibraryInfoWrapperPass>();
 }
 
+namespace rv {
+
+/// analysis result of a prepared clone of a scalar function. All variants of
+/// the function are cloned from \p protoFunc and start from this result.
+struct WFVSharedAnalysis {
+  llvm::Function * protoFunc; // mask materialized, returns unified
+  VectorMapping protoJob;
+  std::unique_ptr<FunctionRegion> funcRegion;
+  std::unique_ptr<Region> funcRegionWrapper;
+  std::unique_ptr<VectorizationInfo> vecInfo;
+  PassBuilder PB;
+  FunctionAnalysisManager FAM;
+
+  WFVSharedAnalysis()
+  : protoFunc(nullptr)
+  {}
+
+  ~WFVSharedAnalysis() {
+    vecInfo.reset();
+    FAM.clear();
+    if (protoFunc) protoFunc->eraseFromParent();
+  }
+};
+
+}
+
+// whether the analysis result for \p protoJob is a sound starting point for \p wfvJob
+// (the shapes of the analysis can only rise on update).
+static bool
+CanReuseAnalysis(const VectorMapping & protoJob, const VectorMapping & wfvJob) {
+  if (protoJob.argShapes.size() != wfvJob.argShapes.size()) return false;
+  for (auto argIdx : seq<size_t>(0, wfvJob.argShapes.size())) {
+    if (!wfvJob.argShapes[argIdx].contains(protoJob.argShapes[argIdx])) return false;
+  }
+  return true;
+}
+
+std::unique_ptr<WFVSharedAnalysis>
+WFVPass::createSharedAnalysis(VectorizerInterface & vectorizer, const VectorMapping & wfvJob) const {
+  auto sharedVA = std::make_unique<WFVSharedAnalysis>();
+
+  // prepare the clone that all variants start from
+  ValueToValueMapTy cloneMap;
+  sharedVA->protoFunc = CloneFunction(wfvJob.scalarFn, cloneMap, nullptr);
+  sharedVA->protoJob = wfvJob;
+  sharedVA->protoJob.scalarFn = sharedVA->protoFunc;
+
+  if (wfvJob.maskPos >= 0) {
+    MaterializeEntryMask(*sharedVA->protoFunc, vectorizer.getPlatformInfo());
+  }
+
+  sharedVA->funcRegion = std::make_unique<FunctionRegion>(*sharedVA->protoFunc);
+  sharedVA->funcRegionWrapper = std::make_unique<Region>(*sharedVA->funcRegion);
+  SingleReturnTrans::run(*sharedVA->funcRegionWrapper);
+
+  // analyze once
+  sharedVA->PB.registerFunctionAnalyses(sharedVA->FAM);
+  sharedVA->vecInfo = std::make_unique<VectorizationInfo>(*sharedVA->funcRegionWrapper, sharedVA->protoJob);
+  vectorizer.analyze(*sharedVA->vecInfo, sharedVA->FAM);
+
+  return sharedVA;
+}
+
 void
-WFVPass::vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfvJob) {
-  // clone scalar function
+WFVPass::vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfvJob,
+                           WFVSharedAnalysis * sharedVA) const {
+  // clone scalar function (or the prepared function of the shared analysis)
   ValueToValueMapTy cloneMap;
-  Function* scalarCopy = CloneFunction(wfvJob.scalarFn, cloneMap, nullptr);
+  Function* srcFunc = sharedVA ? sharedVA->protoFunc : wfvJob.scalarFn;
+  Function* scalarCopy = CloneFunction(srcFunc, cloneMap, nullptr);
   wfvJob.scalarFn = scalarCopy;
 
-  if (wfvJob.maskPos >= 0) {
+  if (!sharedVA && wfvJob.maskPos >= 0) {
     MaterializeEntryMask(*scalarCopy, vectorizer.getPlatformInfo());
   }
 
@@ -77,7 +151,7 @@ WFVPass::vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfv
   Region funcRegionWrapper(funcRegion);
 
   // unify returns as necessary
-  SingleReturnTrans::run(funcRegionWrapper);
+  if (!sharedVA) SingleReturnTrans::run(funcRegionWrapper);
 
   // prepare analyses
   PassBuilder PB;
@@ -95,7 +169,36 @@ WFVPass::vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfv
 
 // Vectorize
   // vectorizationAnalysis
-  vectorizer.analyze(vecInfo, FAM); // TODO can be shared across jobs
+  if (sharedVA && CanReuseAnalysis(sharedVA->protoJob, wfvJob)) {
+    vecInfo.copyInferredProperties(*sharedVA->vecInfo, cloneMap, FAM.getResult<LoopAnalysis>(*scalarCopy));
+
+    std::vector<const Instruction*> updateList;
+    // users of arguments with a different shape
+    for (auto argIdx : seq<size_t>(0, wfvJob.argShapes.size())) {
+      if (wfvJob.argShapes[argIdx] == sharedVA->protoJob.argShapes[argIdx]) continue;
+      for (auto * user : scalarCopy->getArg(argIdx)->users()) {
+        if (auto * userInst = dyn_cast<Instruction>(user)) updateList.push_back(userInst);
+      }
+    }
+
+    // allocas are seeded with the vector width, resolver queries depend on it
+    if (wfvJob.vectorWidth != sharedVA->protoJob.vectorWidth) {
+      for (auto & inst : instructions(*scalarCopy)) {
+        if (isa<AllocaInst>(inst)) {
+          auto allocaShape = VectorShape::join(vecInfo.getVectorShape(inst), VectorShape::uni(wfvJob.vectorWidth));
+          vecInfo.setVectorShape(inst, allocaShape);
+          for (auto * user : inst.users()) updateList.push_back(cast<Instruction>(user));
+        } else if (isa<CallBase>(inst)) {
+          updateList.push_back(&inst);
+        }
+      }
+    }
+
+    if (!updateList.empty()) vectorizer.updateAnalysis(vecInfo, FAM, updateList);
+
+  } else {
+    vectorizer.analyze(vecInfo, FAM);
+  }
 
   if (enableDiagOutput) {
     errs() << "-- VA result --\n";
@@ -126,6 +229,31 @@ WFVPass::vectorizeFunction(VectorizerInterface & vectorizer, VectorMapping & wfv
   scalarCopy->eraseFromParent();
 }
 
+void
+WFVPass::vectorizeJobs(VectorizerInterface & vectorizer, std::vector<VectorMapping> & jobs) const {
+  // variants are prepared (and analyzed) per scalar function and masking
+  using PrepKey = std::pair<Function*, bool>;
+  auto getPrepKey = [](const VectorMapping & job) { return PrepKey(job.scalarFn, job.maskPos >= 0); };
+
+  std::map<PrepKey, unsigned> numVariants;
+  for (auto & job : jobs) numVariants[getPrepKey(job)]++;
+
+  std::map<PrepKey, std::unique_ptr<WFVSharedAnalysis>> sharedVAs;
+  for (auto & job : jobs) {
+    auto prepKey = getPrepKey(job);
+
+    // nothing to share
+    if (numVariants[prepKey] <= 1) {
+      vectorizeFunction(vectorizer, job, nullptr);
+      continue;
+    }
+
+    auto & sharedVA = sharedVAs[prepKey];
+    if (!sharedVA) sharedVA = createSharedAnalysis(vectorizer, job);
+    vectorizeFunction(vectorizer, job, sharedVA.get());
+  }
+}
+
 bool
 WFVPass::isSaneMapping(VectorMapping & wfvJob) const {
   DataLayout DL(wfvJob.scalarFn->getParent());
@@ -168,10 +296,263 @@ WFVPass::collectJobs(Function & F) {
   }
 }
 
+std::vector<std::vector<unsigned>>
+WFVPass::clusterJobs() const {
+  // union-find over job indices
+  std::vector<unsigned> leader(wfvJobs.size());
+  std::iota(leader.begin(), leader.end(), 0);
+  auto findLeader = [&](unsigned i) {
+    while (leader[i] != i) i = leader[i] = leader[leader[i]];
+    return i;
+  };
+  auto unite = [&](unsigned a, unsigned b) {
+    a = findLeader(a); b = findLeader(b);
+    if (a != b) leader[std::max(a, b)] = std::min(a, b);
+  };
+
+  // variants of the same scalar function (and jobs sharing a vector function)
+  DenseMap<const Function*, unsigned> jobOfFunc;
+  for (unsigned i = 0; i < wfvJobs.size(); ++i) {
+    for (const Function * F : {wfvJobs[i].scalarFn, wfvJobs[i].vectorFn}) {
+      auto itInserted = jobOfFunc.insert(std::make_pair(F, i));
+      if (!itInserted.second) unite(i, itInserted.first->second);
+    }
+  }
+
+  // scalar functions that call into other job functions (recursive vectorization)
+  for (unsigned i = 0; i < wfvJobs.size(); ++i) {
+    for (auto & inst : instructions(*wfvJobs[i].scalarFn)) {
+      auto * call = dyn_cast<CallBase>(&inst);
+      if (!call) continue;
+      auto * callee = call->getCalledFunction();
+      if (!callee) continue;
+      auto itJob = jobOfFunc.find(callee);
+      if (itJob != jobOfFunc.end()) unite(i, itJob->second);
+    }
+  }
+
+  // clusters (and the jobs within) follow the order of wfvJobs
+  std::vector<std::vector<unsigned>> clusters;
+  DenseMap<unsigned, unsigned> clusterOfLeader;
+  for (unsigned i = 0; i < wfvJobs.size(); ++i) {
+    auto itInserted = clusterOfLeader.insert(std::make_pair(findLeader(i), clusters.size()));
+    if (itInserted.second) clusters.emplace_back();
+    clusters[itInserted.first->second].push_back(i);
+  }
+  return clusters;
+}
+
+// the linker concatenates appending globals (llvm.global_ctors, llvm.used, ..).
+// only keep the entries that were added after the first @numSnapshotEntries.
+static void
+DropSnapshotEntries(GlobalVariable & GV, unsigned numSnapshotEntries) {
+  auto * initArr = GV.hasInitializer() ? dyn_cast<ConstantArray>(GV.getInitializer()) : nullptr;
+  unsigned numEntries = initArr ? initArr->getNumOperands() : 0;
+  if (numEntries <= numSnapshotEntries) {
+    GV.eraseFromParent();
+    return;
+  }
+
+  std::vector<Constant*> newEntries;
+  for (unsigned i = numSnapshotEntries; i < numEntries; ++i) {
+    newEntries.push_back(initArr->getOperand(i));
+  }
+  auto * arrTy = ArrayType::get(initArr->getType()->getElementType(), newEntries.size());
+  auto * newGV = new GlobalVariable(*GV.getParent(), arrTy, GV.isConstant(), GlobalValue::AppendingLinkage,
+                                    ConstantArray::get(arrTy, newEntries), "", &GV);
+  newGV->setSection(GV.getSection());
+  newGV->takeName(&GV);
+  GV.eraseFromParent();
+}
+
+void
+WFVPass::vectorizeCluster(Module & workMod, ArrayRef<unsigned> cluster,
+                          TargetTransformInfo * TTI, TargetLibraryInfo * TLI,
+                          const Config & rvConfig, std::string & resultBC,
+                          std::string & reportText) const {
+  // buffer the diagnostic output of this worker
+  raw_string_ostream reportOut(reportText);
+  SetThreadReportStream(&reportOut);
+
+  StringSet<> snapshotSymbols;
+  for (auto & GV : workMod.global_values()) snapshotSymbols.insert(GV.getName());
+
+  StringMap<unsigned> numSnapshotEntries;
+  for (auto & GV : workMod.globals()) {
+    if (!GV.hasAppendingLinkage()) continue;
+    auto * initArr = GV.hasInitializer() ? dyn_cast<ConstantArray>(GV.getInitializer()) : nullptr;
+    numSnapshotEntries[GV.getName()] = initArr ? initArr->getNumOperands() : 0;
+  }
+
+  // re-target all jobs to the private module
+  auto lookupJob = [&](const VectorMapping & job) {
+    VectorMapping localJob = job;
+    localJob.scalarFn = workMod.getFunction(job.scalarFn->getName());
+    localJob.vectorFn = workMod.getFunction(job.vectorFn->getName());
+    assert(localJob.scalarFn && localJob.vectorFn && "job function missing in snapshot");
+    return localJob;
+  };
+
+  PlatformInfo platInfo(workMod, TTI, TLI);
+  addSleefResolver(rvConfig, platInfo);
+
+  // add mappings for recursive vectorization
+  for (auto & job : wfvJobs) {
+    platInfo.addMapping(lookupJob(job));
+  }
+
+  // vectorize jobs
+  VectorizerInterface vectorizer(platInfo, rvConfig);
+  StringSet<> vectorFuncs;
+  std::vector<VectorMapping> localJobs;
+  for (unsigned jobIdx : cluster) {
+    localJobs.push_back(lookupJob(wfvJobs[jobIdx]));
+    vectorFuncs.insert(localJobs.back().vectorFn->getName());
+  }
+  vectorizeJobs(vectorizer, localJobs);
+
+  // strip everything but the new vector functions and the helpers they pulled in
+  for (auto & F : workMod) {
+    if (vectorFuncs.count(F.getName())) continue;
+    if (snapshotSymbols.count(F.getName())) {
+      if (F.isDeclaration()) continue;
+      F.deleteBody();
+      F.setComdat(nullptr);
+      continue;
+    }
+    // helpers (eg SLEEF implementations) may be imported by several workers
+    if (!F.isDeclaration() && !F.hasLocalLinkage())
+      F.setLinkage(GlobalValue::LinkOnceODRLinkage);
+  }
+
+  std::vector<GlobalVariable*> appendingGlobals;
+  for (auto & GV : workMod.globals()) {
+    if (GV.hasAppendingLinkage()) {
+      appendingGlobals.push_back(&GV);
+      continue;
+    }
+    if (snapshotSymbols.count(GV.getName())) {
+      GV.setInitializer(nullptr);
+      GV.setLinkage(GlobalValue::ExternalLinkage);
+      GV.setComdat(nullptr);
+      continue;
+    }
+    if (GV.hasInitializer() && !GV.hasLocalLinkage())
+      GV.setLinkage(GlobalValue::LinkOnceODRLinkage);
+  }
+  for (auto * GV : appendingGlobals) {
+    DropSnapshotEntries(*GV, numSnapshotEntries.lookup(GV->getName()));
+  }
+
+  raw_string_ostream resultOut(resultBC);
+  WriteBitcodeToFile(workMod, resultOut);
+  resultOut.flush();
+
+  SetThreadReportStream(nullptr);
+  reportOut.flush();
+}
+
+void
+WFVPass::runParallel(Module & M, Function & protoFunc, const Config & rvConfig) {
+  auto clusters = clusterJobs();
+
+  if (enableDiagOutput) {
+    Report() << "wfv: vectorizing " << wfvJobs.size() << " jobs in "
+             << clusters.size() << " clusters on " << numThreads << " threads\n";
+  }
+
+  // worker results refer to symbols of M by name -> make local symbols
+  // temporarily visible.
+  struct PromotedSymbol {
+    GlobalValue * GV;
+    GlobalValue::LinkageTypes linkage;
+    bool unnamed;
+  };
+  std::vector<PromotedSymbol> promotedSymbols;
+  for (auto & GV : M.global_values()) {
+    if (!GV.hasLocalLinkage()) continue;
+    promotedSymbols.push_back({&GV, GV.getLinkage(), !GV.hasName()});
+    if (!GV.hasName()) GV.setName("rv.wfv.local");
+    GV.setLinkage(GlobalValue::ExternalLinkage);
+  }
+
+  SmallVector<char, 0> snapshotBuffer;
+  {
+    raw_svector_ostream snapshotOut(snapshotBuffer);
+    WriteBitcodeToFile(M, snapshotOut);
+  }
+  StringRef snapshot(snapshotBuffer.data(), snapshotBuffer.size());
+
+  // private module copy and target info for every worker (TTI and TLI are not thread-safe).
+  // the target info is created here, one worker at a time, for the prototype function in the worker's own module
+  // (TTI queries use the DataLayout of that module).
+  auto & TTIWrapper = getAnalysis<TargetTransformInfoWrapperPass>();
+  auto & TLIWrapper = getAnalysis<TargetLibraryInfoWrapperPass>();
+  std::vector<std::unique_ptr<LLVMContext>> workerContexts;
+  std::vector<std::unique_ptr<Module>> workerMods;
+  std::vector<TargetTransformInfo> workerTTIs;
+  std::vector<TargetLibraryInfo> workerTLIs;
+  workerContexts.reserve(clusters.size());
+  workerMods.reserve(clusters.size());
+  workerTTIs.reserve(clusters.size());
+  workerTLIs.reserve(clusters.size());
+  for (unsigned i = 0; i < clusters.size(); ++i) {
+    workerContexts.push_back(std::make_unique<LLVMContext>());
+    auto modOrErr = parseBitcodeFile(MemoryBufferRef(snapshot, "rv-wfv-snapshot"), *workerContexts.back());
+    if (!modOrErr) fail("wfv: could not read module snapshot: " + toString(modOrErr.takeError()));
+    workerMods.push_back(std::move(*modOrErr));
+
+    auto * workerProtoFunc = workerMods.back()->getFunction(protoFunc.getName());
+    assert(workerProtoFunc && "prototype function missing in snapshot");
+
+    // getTTI rebuilds its result on every query - take it over before the next one
+    workerTTIs.push_back(std::move(TTIWrapper.getTTI(*workerProtoFunc)));
+    workerTLIs.push_back(TLIWrapper.getTLI(*workerProtoFunc));
+  }
+
+  // the -time-passes timers are shared by all threads
+  Config workerConfig = rvConfig;
+  workerConfig.enablePhaseTimers = false;
+
+  std::vector<std::string> resultBCs(clusters.size());
+  std::vector<std::string> reportTexts(clusters.size());
+  {
+    ThreadPool pool(hardware_concurrency(numThreads));
+    for (unsigned i = 0; i < clusters.size(); ++i) {
+      pool.async([&, i] {
+        vectorizeCluster(*workerMods[i], clusters[i], &workerTTIs[i], &workerTLIs[i], workerConfig,
+                         resultBCs[i], reportTexts[i]);
+      });
+    }
+    pool.wait();
+  }
+
+  // link the results in cluster order (independent of the thread schedule)
+  for (unsigned i = 0; i < clusters.size(); ++i) {
+    ReportContinue() << reportTexts[i];
+
+    auto resultOrErr = parseBitcodeFile(MemoryBufferRef(resultBCs[i], "rv-wfv-result"), M.getContext());
+    if (!resultOrErr) fail("wfv: could not read worker result: " + toString(resultOrErr.takeError()));
+    if (Linker::linkModules(M, std::move(*resultOrErr)))
+      fail("wfv: could not link worker result");
+  }
+
+  // the linked vector functions refer to the symbols directly -> restore names and linkage
+  for (auto & promoted : promotedSymbols) {
+    promoted.GV->setLinkage(promoted.linkage);
+    if (promoted.unnamed) promoted.GV->setName("");
+  }
+}
+
 bool
 WFVPass::runOnModule(Module & M) {
   enableDiagOutput = CheckFlag("WFV_DIAG");
 
+  // number of worker threads (default: vectorize on the calling thread)
+  numThreads = 1;
+  char * threadsText = getenv("RV_WFV_THREADS");
+  if (threadsText) numThreads = std::max(1, atoi(threadsText));
+
   // collect WFV jobs
   for (auto & func : M) {
     if (func.isDeclaration()) continue;
@@ -184,12 +565,20 @@ WFVPass::runOnModule(Module & M) {
  
   auto & protoFunc = *wfvJobs[0].scalarFn;
 
+  // FIXME this assumes that all functions were compiled for the same target
+  Config rvConfig = Config::createForFunction(protoFunc);
+
+  // aliases/ifuncs can not be split off into worker modules
+  bool parallelOk = numThreads > 1 && wfvJobs.size() > 1 &&
+                    M.alias_empty() && M.ifunc_empty();
+  if (parallelOk) {
+    runParallel(M, protoFunc, rvConfig);
+    return true;
+  }
+
   // configure platform info
   auto & TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(protoFunc);
-
-  // FIXME this assumes that all functions were compiled for the same target
   auto & TTI = getAnalysis<TargetTransformInfoWrapperPass>().getTTI(protoFunc);
-  Config rvConfig = Config::createForFunction(protoFunc);
 
   // configure platInfo
   PlatformInfo platInfo(M, &TTI, &TLI);
@@ -202,9 +591,7 @@ WFVPass::runOnModule(Module & M) {
 
   // vectorize jobs
   VectorizerInterface vectorizer(platInfo, rvConfig);
-  for (auto & job : wfvJobs) {
-    vectorizeFunction(vectorizer, job);
-  }
+  vectorizeJobs(vectorizer, wfvJobs);
 
   return true;
 }
@@ -9,6 +9,7 @@
 
 #include "rv/transform/bosccTransform.h"
 #include "rv/analysis/BranchEstimate.h"
+#include "rv/analysis/LaneProfile.h"
 
 #include <vector>
 #include <sstream>
@@ -64,12 +65,14 @@ struct Impl {
   BranchProbabilityInfo *pbInfo;
 
   BranchEstimate BranchEst;
+  bool useHeuristics;
+  const LaneProfile * laneProfile;
 
   // BOSCC region exit blocks (containing merge phis)
   BlockSet bosccExitBlocks;
 
 
-Impl(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo,  MaskExpander & _maskEx, DominatorTree & _domTree, PostDominatorTree & _postDomTree, LoopInfo & _loopInfo, BranchProbabilityInfo * _pbInfo)
+Impl(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo,  MaskExpander & _maskEx, DominatorTree & _domTree, PostDominatorTree & _postDomTree, LoopInfo & _loopInfo, BranchProbabilityInfo * _pbInfo, bool _useHeuristics)
 : vecInfo(_vecInfo)
 , platInfo(_platInfo)
 , maskEx(_maskEx)
@@ -79,6 +82,8 @@ Impl(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo,  MaskExpander & _ma
 , mod(*vecInfo.getScalarFunction().getParent())
 , pbInfo(_pbInfo)
 , BranchEst(vecInfo, platInfo, maskEx, domTree, loopInfo, pbInfo)
+, useHeuristics(_useHeuristics)
+, laneProfile(LaneProfile::getProfile())
 , bosccExitBlocks()
 {}
 
@@ -303,6 +308,16 @@ PickSuccessorForBoscc(BranchInst & branch) {
     errs () << "BOSCC: onFalseLegal to " << branch.getSuccessor(1)->getName() << " = " << onFalseLegal << "\n";
   }
 
+  // profile-guided decision: skip the successor that most often has no active lane
+  const double minNoneRatio = GetValue<double>("BOSCC_PROFILE_T", 0.30);
+  auto getNoneScore = [&](const LaneStats * stats) { return (stats ? stats->getNoneRatio() : 0.0) - minNoneRatio; };
+  int profileDecision;
+  if (laneProfile && laneProfile->pickSuccessor(branch, vecInfo.getMapping().vectorFn->getName(), onTrueLegal, onFalseLegal, getNoneScore, profileDecision)) {
+    IF_DEBUG_BOSCC { errs() << "BOSCC: profiled decision " << profileDecision << ", BOSCC_PROFILE_T=" << minNoneRatio << "\n"; }
+    return profileDecision;
+  }
+  if (!useHeuristics) return 0;
+
   double trueRatio = 0.0;
   double falseRatio = 0.0;
   size_t onTrueScore = 0;
@@ -397,12 +412,12 @@ run() {
 
 bool
 BOSCCTransform::run() {
-  Impl impl(vecInfo, platInfo, maskEx, domTree, postDomTree, loopInfo, pbInfo);
+  Impl impl(vecInfo, platInfo, maskEx, domTree, postDomTree, loopInfo, pbInfo, useHeuristics);
   return impl.run();
 }
 
 
-BOSCCTransform::BOSCCTransform(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo, MaskExpander & _maskEx, FunctionAnalysisManager &FAM)
+BOSCCTransform::BOSCCTransform(VectorizationInfo & _vecInfo, PlatformInfo & _platInfo, MaskExpander & _maskEx, FunctionAnalysisManager &FAM, bool _useHeuristics)
 : vecInfo(_vecInfo)
 , platInfo(_platInfo)
 , maskEx(_maskEx)
@@ -410,4 +425,5 @@ BOSCCTransform::BOSCCTransform(VectorizationInfo & _vecInfo, PlatformInfo & _pla
 , postDomTree(FAM.getResult<PostDominatorTreeAnalysis>(vecInfo.getScalarFunction()))
 , loopInfo(*FAM.getCachedResult<LoopAnalysis>(vecInfo.getScalarFunction()))
 , pbInfo(&FAM.getResult<BranchProbabilityAnalysis>(vecInfo.getScalarFunction()))
+, useHeuristics(_useHeuristics)
 {}
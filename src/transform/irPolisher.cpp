@@ -9,6 +9,7 @@
 
 #include "llvm/Transforms/Utils/ValueMapper.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Local.h"
 
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Transforms/Scalar.h"
@@ -21,6 +22,7 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/PatternMatch.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Passes/PassBuilder.h"
 
 #include "rv/transform/irPolisher.h"
@@ -547,20 +549,148 @@ llvm::Value *IRPolisher::getConditionFromMask(IRBuilder<> &builder, llvm::Value*
   return builder.CreateICmpNE(value, Constant::getNullValue(value->getType()));
 }
 
+// Run InstCombine to perform peephole opts
+static void
+RunPeepholeOpts(Function & F) {
+  FunctionPassManager FPM;
+  FunctionAnalysisManager FAM;
+  PassBuilder builder;
+  builder.registerFunctionAnalyses(FAM);
+  FPM.addPass(AggressiveInstCombinePass());
+  FPM.run(F, FAM);
+}
+
+// Bitcast a <n x i1> mask to an n-bit integer (kmov)
+static Value*
+CreateMaskBits(IRBuilder<> & builder, Value * mask) {
+  return builder.CreateBitCast(mask, builder.getIntNTy(GetVectorNumElements(mask->getType())));
+}
+
+Value *IRPolisher::lowerMaskReduction(llvm::CallInst* callInst) {
+  auto callee = callInst->getCalledFunction();
+  if (!callee || callInst->arg_size() != 1) return nullptr;
+
+  auto arg = callInst->getArgOperand(0);
+  if (!isBooleanVector(arg->getType()) || GetVectorNumElements(arg->getType()) > 64) return nullptr;
+
+  auto isReduceOr = startsWith(callee->getName().data(), "rv_reduce_or") || callee->getIntrinsicID() == Intrinsic::vector_reduce_or;
+  auto isReduceAnd = startsWith(callee->getName().data(), "rv_reduce_and") || callee->getIntrinsicID() == Intrinsic::vector_reduce_and;
+  if (!isReduceOr && !isReduceAnd) return nullptr;
+
+  // Test the mask register (kortest)
+  IRBuilder<> builder(callInst);
+  auto maskBits = CreateMaskBits(builder, arg);
+  return isReduceOr
+    ? builder.CreateICmpNE(maskBits, Constant::getNullValue(maskBits->getType()))
+    : builder.CreateICmpEQ(maskBits, Constant::getAllOnesValue(maskBits->getType()));
+}
+
+Value *IRPolisher::lowerMoveMask(llvm::CallInst* callInst) {
+  auto callee = callInst->getCalledFunction();
+  if (!callee) return nullptr;
+  switch (callee->getIntrinsicID()) {
+    case Intrinsic::x86_sse_movmsk_ps:
+    case Intrinsic::x86_sse2_movmsk_pd:
+    case Intrinsic::x86_avx_movmsk_ps_256:
+    case Intrinsic::x86_avx_movmsk_pd_256:
+      break;
+    default:
+      return nullptr;
+  }
+
+  // movmsk(bitcast(sext(m))) round-trips the mask through a vector register
+  auto arg = callInst->getArgOperand(0);
+  size_t numMoveMaskLanes = GetVectorNumElements(arg->getType());
+  if (auto bitCast = dyn_cast<BitCastInst>(arg)) arg = bitCast->getOperand(0);
+  auto sextInst = dyn_cast<SExtInst>(arg);
+  if (!sextInst || !isBooleanVector(sextInst->getSrcTy())) return nullptr;
+
+  // every bit of the movmsk result has to stem from one lane of m (eg not <8 x i1> -> <8 x i16> -> <4 x float>)
+  if (GetVectorNumElements(sextInst->getSrcTy()) != numMoveMaskLanes) return nullptr;
+
+  IRBuilder<> builder(callInst);
+  return builder.CreateZExt(CreateMaskBits(builder, sextInst->getOperand(0)), callInst->getType());
+}
+
+Value *IRPolisher::foldMaskedArithmetic(llvm::Instruction* inst) {
+  using namespace llvm::PatternMatch;
+  if (!inst->getType()->isVectorTy() || isBooleanVector(inst->getType())) return nullptr;
+
+  IRBuilder<> builder(inst);
+  Value *mask, *val;
+
+  // Zero masking: and(v, sext(m)) -> select(m, v, 0)
+  if (match(inst, m_c_And(m_SExt(m_Value(mask)), m_Value(val))) && isBooleanVector(mask->getType())) {
+    return builder.CreateSelect(mask, val, Constant::getNullValue(val->getType()));
+  }
+
+  // Masked increments: add(v, zext(m)) -> select(m, v + 1, v) (and decrements)
+  if (!inst->getType()->isIntOrIntVectorTy()) return nullptr;
+  auto one = ConstantInt::get(inst->getType(), 1);
+  if (match(inst, m_c_Add(m_ZExt(m_Value(mask)), m_Value(val))) && isBooleanVector(mask->getType())) {
+    return builder.CreateSelect(mask, builder.CreateAdd(val, one), val);
+  }
+  if ((match(inst, m_c_Add(m_SExt(m_Value(mask)), m_Value(val))) ||
+       match(inst, m_Sub(m_Value(val), m_ZExt(m_Value(mask))))) && isBooleanVector(mask->getType())) {
+    return builder.CreateSelect(mask, builder.CreateSub(val, one), val);
+  }
+
+  return nullptr;
+}
+
+bool IRPolisher::polishPredicates() {
+  IF_DEBUG { errs() << "Starting predicate polishing phase (AVX-512)\n"; }
+
+  RunPeepholeOpts(F);
+
+  // Folded instructions may delete their dead operands
+  std::vector<WeakVH> insts;
+  for (auto it = inst_begin(F), end = inst_end(F); it != end; ++it) {
+    insts.emplace_back(&*it);
+  }
+
+  size_t numPolished = 0;
+  for (auto &instHandle : insts) {
+    auto inst = dyn_cast_or_null<Instruction>(instHandle);
+    if (!inst) continue;
+
+    Value * newInst = nullptr;
+    if (auto callInst = dyn_cast<CallInst>(inst)) {
+      newInst = lowerMaskReduction(callInst);
+      if (!newInst) newInst = lowerMoveMask(callInst);
+    } else {
+      newInst = foldMaskedArithmetic(inst);
+    }
+    if (!newInst) continue;
+
+    // Drop the replaced instruction and the mask expansions that fed it
+    std::vector<Value*> oldOps(inst->op_begin(), inst->op_end());
+    inst->replaceAllUsesWith(newInst);
+    inst->eraseFromParent();
+    for (auto oldOp : oldOps) RecursivelyDeleteTriviallyDeadInstructions(oldOp);
+    ++numPolished;
+  }
+
+  if (numPolished > 0) {
+    Report() << "IRPolish: polished " << numPolished << " mask pattern(s) for AVX-512\n";
+  }
+
+  return numPolished > 0;
+}
+
 bool IRPolisher::polish() {
+  // keep the <n x i1> masks in k-registers
+  if (config.useAVX512) {
+    return polishPredicates();
+  }
+
   if (!(config.useAVX || config.useAVX2)) {
     return false; // requires >= AVX
   }
 
   IF_DEBUG { errs() << "Starting polishing phase\n"; }
 
-  // Run InstCombine to perform peephole opts
-  FunctionPassManager FPM;
-  FunctionAnalysisManager FAM;
-  PassBuilder builder;
-  builder.registerFunctionAnalyses(FAM);
-  FPM.addPass(AggressiveInstCombinePass());
-  FPM.run(F, FAM);
+  RunPeepholeOpts(F);
 
   visitedInsts.clear();
   queue = std::queue<ExtInst>();
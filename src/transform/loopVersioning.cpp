@@ -0,0 +1,366 @@
+//===- src/transform/loopVersioning.cpp - runtime checks and alignment peeling --*- C++ -*-===//
+//
+// Part of the RV Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+
+#include "rv/transform/loopVersioning.h"
+
+#include "rv/transform/loopCloner.h"
+#include "rv/analysis/loopAnnotations.h"
+#include "rv/annotations.h"
+#include "rv/utils.h"
+
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/MathExtras.h"
+
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Transforms/Utils/ScalarEvolutionExpander.h"
+
+#include "rvConfig.h"
+#include "rv/rvDebug.h"
+#include "report.h"
+
+#if 1
+#define IF_DEBUG_VERS IF_DEBUG
+#else
+#define IF_DEBUG_VERS if (true)
+#endif
+
+using namespace llvm;
+
+namespace rv {
+
+// upper bound on the number of emitted overlap checks
+static const size_t MaxOverlapChecks = 32;
+
+static Type*
+GetAccessedType(Instruction & memInst) {
+  if (auto * load = dyn_cast<LoadInst>(&memInst)) return load->getType();
+  return cast<StoreInst>(memInst).getValueOperand()->getType();
+}
+
+bool
+LoopVersioningTransform::analyzeOverlapChecks(Loop & L, int vectorWidth) {
+  accessRanges.clear();
+  overlapChecks.clear();
+
+  const auto & DL = F.getParent()->getDataLayout();
+
+  auto * backedgeCount = SE.getBackedgeTakenCount(&L);
+  if (isa<SCEVCouldNotCompute>(backedgeCount)) {
+    Report() << "loopVersioning: can not compute the trip count of " << L.getName() << "\n";
+    return false;
+  }
+
+  // (address, base, isWrite) for all memory accesses
+  struct MemAccess {
+    const SCEV * addr;
+    const SCEV * base;
+    const SCEV * step; // nullptr for loop invariant addresses
+    bool isWrite;
+  };
+  std::vector<MemAccess> accesses;
+
+  for (auto * BB : L.blocks()) {
+    for (auto & inst : *BB) {
+      if (!inst.mayReadOrWriteMemory()) continue;
+
+      auto * load = dyn_cast<LoadInst>(&inst);
+      auto * store = dyn_cast<StoreInst>(&inst);
+      if ((!load || !load->isSimple()) && (!store || !store->isSimple())) {
+        Report() << "loopVersioning: can not check memory accesses of " << inst << "\n";
+        return false;
+      }
+
+      auto * ptr = getLoadStorePointerOperand(&inst);
+      auto * addr = SE.getSCEV(ptr);
+      uint64_t accessSize = DL.getTypeStoreSize(GetAccessedType(inst));
+      auto * sizeTy = SE.getEffectiveSCEVType(addr->getType());
+
+      AccessRange range;
+      const SCEV * step = nullptr;
+      if (SE.isLoopInvariant(addr, &L)) {
+        if (store) {
+          Report() << "loopVersioning: loop invariant store " << inst << "\n";
+          return false;
+        }
+        range.lo = addr;
+        range.hi = SE.getAddExpr(addr, SE.getConstant(sizeTy, accessSize));
+
+      } else {
+        auto * addrRec = dyn_cast<SCEVAddRecExpr>(addr);
+        if (!addrRec || addrRec->getLoop() != &L || !addrRec->isAffine()) {
+          Report() << "loopVersioning: non-affine address of " << inst << "\n";
+          return false;
+        }
+
+        auto * stepConst = dyn_cast<SCEVConstant>(addrRec->getStepRecurrence(SE));
+        if (!stepConst) {
+          Report() << "loopVersioning: non-constant stride of " << inst << "\n";
+          return false;
+        }
+        step = stepConst;
+
+        auto * start = addrRec->getStart();
+        auto * iterCount = SE.getTruncateOrZeroExtend(backedgeCount, stepConst->getType());
+        auto * end = SE.getAddExpr(start, SE.getMulExpr(iterCount, stepConst));
+        if (stepConst->getAPInt().isNonNegative()) {
+          range.lo = start;
+          range.hi = SE.getAddExpr(end, SE.getConstant(sizeTy, accessSize));
+        } else {
+          range.lo = end;
+          range.hi = SE.getAddExpr(start, SE.getConstant(sizeTy, accessSize));
+        }
+      }
+
+      accesses.push_back(MemAccess{addr, SE.getPointerBase(addr), step, (bool) store});
+      accessRanges.push_back(range);
+    }
+  }
+
+  for (size_t i = 0; i < accesses.size(); ++i) {
+    for (size_t j = i + 1; j < accesses.size(); ++j) {
+      const auto & A = accesses[i];
+      const auto & B = accesses[j];
+      if (!A.isWrite && !B.isWrite) continue;
+
+      // different underlying objects -> check at runtime
+      if (A.base != B.base) {
+        overlapChecks.emplace_back(i, j);
+        continue;
+      }
+
+      // same object: the accesses have to be at least one vector of iterations apart
+      if (A.addr == B.addr) continue;
+      auto * distConst = dyn_cast<SCEVConstant>(SE.getMinusSCEV(A.addr, B.addr));
+      if (!distConst || !A.step || A.step != B.step) {
+        Report() << "loopVersioning: unknown dependence distance between accesses in " << L.getName() << "\n";
+        return false;
+      }
+
+      int64_t stride = std::abs(cast<SCEVConstant>(A.step)->getAPInt().getSExtValue());
+      int64_t dist = std::abs(distConst->getAPInt().getSExtValue());
+      if (dist < stride * vectorWidth) {
+        Report() << "loopVersioning: dependence distance " << dist << " bytes is shorter than one vector in " << L.getName() << "\n";
+        return false;
+      }
+    }
+  }
+
+  if (overlapChecks.size() > MaxOverlapChecks) {
+    Report() << "loopVersioning: too many overlap checks (" << overlapChecks.size() << ") for " << L.getName() << "\n";
+    return false;
+  }
+
+  IF_DEBUG_VERS { errs() << "loopVersioning: " << overlapChecks.size() << " overlap checks for " << L.getName() << "\n"; }
+  return true;
+}
+
+void
+LoopVersioningTransform::insertOverlapChecks(BasicBlock & vecGuardBlock, BasicBlock & vecHeader) {
+  if (overlapChecks.empty()) return;
+
+  const auto & DL = F.getParent()->getDataLayout();
+  auto & guardBr = *cast<BranchInst>(vecGuardBlock.getTerminator());
+  IRBuilder<> builder(&guardBr);
+  SCEVExpander expander(SE, DL, "rv.memcheck");
+
+  // materialize all bounds as integers
+  std::vector<std::pair<Value*, Value*>> bounds(accessRanges.size(), {nullptr, nullptr});
+  auto requestBound = [&](const SCEV * bound) -> Value* {
+    auto * boundVal = expander.expandCodeFor(bound, bound->getType(), &guardBr);
+    if (!boundVal->getType()->isPointerTy()) return boundVal;
+    return builder.CreatePtrToInt(boundVal, DL.getIntPtrType(boundVal->getType()));
+  };
+  auto requestBounds = [&](size_t idx) -> std::pair<Value*, Value*> {
+    auto & cached = bounds[idx];
+    if (!cached.first) {
+      cached.first = requestBound(accessRanges[idx].lo);
+      cached.second = requestBound(accessRanges[idx].hi);
+    }
+    return cached;
+  };
+
+  Value * noOverlap = builder.getTrue();
+  for (auto check : overlapChecks) {
+    auto A = requestBounds(check.first);
+    auto B = requestBounds(check.second);
+    auto * intTy = A.first->getType();
+    auto * aBeforeB = builder.CreateICmpULE(builder.CreateZExtOrTrunc(A.second, intTy), builder.CreateZExtOrTrunc(B.first, intTy), "rv.memcheck.lt");
+    auto * bBeforeA = builder.CreateICmpULE(builder.CreateZExtOrTrunc(B.second, intTy), builder.CreateZExtOrTrunc(A.first, intTy), "rv.memcheck.gt");
+    noOverlap = builder.CreateAnd(noOverlap, builder.CreateOr(aBeforeB, bBeforeA), "rv.memcheck");
+  }
+
+  // only enter the vector loop if there is no overlap (otw, fall back to the scalar loop)
+  auto * guardCond = guardBr.getCondition();
+  if (guardBr.getSuccessor(0) == &vecHeader) {
+    guardBr.setCondition(builder.CreateAnd(guardCond, noOverlap, "rv.vecguard"));
+  } else {
+    guardBr.setCondition(builder.CreateOr(guardCond, builder.CreateNot(noOverlap), "rv.vecguard"));
+  }
+}
+
+bool
+LoopVersioningTransform::peelForAlignment(Loop & L, int vectorWidth) {
+  const auto & DL = F.getParent()->getDataLayout();
+
+  auto * preHeader = L.getLoopPreheader();
+  auto * exitBlock = L.getExitBlock();
+  auto * exiting = L.getExitingBlock();
+  auto * header = L.getHeader();
+  if (!preHeader || !exitBlock || !exiting || L.getLoopLatch() != exiting) return false;
+
+  // all live outs must be exit phis (LCSSA) to join them with the peel loop
+  for (auto * BB : L.blocks()) {
+    for (auto & inst : *BB) {
+      for (auto * user : inst.users()) {
+        auto * userInst = cast<Instruction>(user);
+        if (L.contains(userInst->getParent())) continue;
+        if (isa<PHINode>(userInst) && userInst->getParent() == exitBlock) continue;
+        return false;
+      }
+    }
+  }
+
+// pick the unit-stride access to align (prefer stores)
+  Instruction * alignedInst = nullptr;
+  const SCEVAddRecExpr * alignedRec = nullptr;
+  uint64_t accessSize = 0;
+  for (auto * BB : L.blocks()) {
+    for (auto & inst : *BB) {
+      if (!isa<LoadInst>(inst) && !isa<StoreInst>(inst)) continue;
+      if (alignedInst && (isa<StoreInst>(alignedInst) || isa<LoadInst>(inst))) continue;
+
+      uint64_t size = DL.getTypeStoreSize(GetAccessedType(inst));
+      if (!isPowerOf2_64(size) || getLoadStoreAlignment(&inst).value() < size) continue;
+
+      auto * addrRec = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(getLoadStorePointerOperand(&inst)));
+      if (!addrRec || addrRec->getLoop() != &L || !addrRec->isAffine()) continue;
+      auto * stepConst = dyn_cast<SCEVConstant>(addrRec->getStepRecurrence(SE));
+      if (!stepConst || stepConst->getAPInt() != size) continue;
+
+      alignedInst = &inst;
+      alignedRec = addrRec;
+      accessSize = size;
+    }
+  }
+  if (!alignedInst) return false;
+
+  uint64_t vectorBytes = accessSize * vectorWidth;
+  // the peel count is computed with a mask (and vectorBytes becomes an alignment hint)
+  if (!isPowerOf2_64(vectorBytes)) return false;
+
+  std::string loopName = L.getName().str();
+  auto & ctx = header->getContext();
+
+  IF_DEBUG_VERS { errs() << "loopVersioning: peeling " << loopName << " to align " << *alignedInst << " to " << vectorBytes << " bytes\n"; }
+
+// clone the peel loop
+  ValueToValueMapTy cloneMap;
+  auto cloneInfo = CloneLoop(L, F, DT, PDT, LI, PB, cloneMap);
+  auto & peelLoop = cloneInfo.clonedLoop;
+  auto & peelHeader = *peelLoop.getHeader();
+  auto & peelLatch = LookUp(cloneMap, *exiting);
+
+  // the peel loop is never vectorized
+  LoopMD peelLoopMD;
+  peelLoopMD.alreadyVectorized = true;
+  SetLLVMLoopAnnotations(peelLoop, std::move(peelLoopMD));
+
+  auto * peelGuard = BasicBlock::Create(ctx, loopName + ".peelg", &F, &peelHeader);
+  auto * peelNext = BasicBlock::Create(ctx, loopName + ".peelnext", &F, header);
+  auto * afterPeel = BasicBlock::Create(ctx, loopName + ".peelexit", &F, header);
+  if (auto * parentLoop = L.getParentLoop()) {
+    parentLoop->addBasicBlockToLoop(peelGuard, LI);
+    parentLoop->addBasicBlockToLoop(afterPeel, LI);
+  }
+  peelLoop.addBasicBlockToLoop(peelNext, LI);
+
+// number of iterations to peel: ((-start) mod vectorBytes) / accessSize
+  preHeader->getTerminator()->replaceUsesOfWith(header, peelGuard);
+
+  IRBuilder<> guardBuilder(peelGuard);
+  SCEVExpander expander(SE, DL, "rv.peel");
+  auto * startBr = guardBuilder.CreateUnreachable(); // temporary insert point for the expander
+  auto * startPtr = expander.expandCodeFor(alignedRec->getStart(), alignedRec->getStart()->getType(), startBr);
+  guardBuilder.SetInsertPoint(startBr);
+  auto * intPtrTy = DL.getIntPtrType(startPtr->getType());
+  auto * startInt = guardBuilder.CreatePtrToInt(startPtr, intPtrTy, loopName + ".start");
+  auto * peelBytes = guardBuilder.CreateAnd(guardBuilder.CreateNeg(startInt), ConstantInt::get(intPtrTy, vectorBytes - 1));
+  auto * numPeel = guardBuilder.CreateLShr(peelBytes, ConstantInt::get(intPtrTy, Log2_64(accessSize)), loopName + ".numpeel");
+  auto * skipPeel = guardBuilder.CreateICmpEQ(numPeel, ConstantInt::get(intPtrTy, 0));
+  guardBuilder.CreateCondBr(skipPeel, afterPeel, &peelHeader);
+  startBr->eraseFromParent();
+
+// count the peeled iterations
+  IRBuilder<> peelBuilder(&peelHeader, peelHeader.begin());
+  auto * peelCounter = peelBuilder.CreatePHI(intPtrTy, 2, loopName + ".peelcnt");
+  peelCounter->addIncoming(ConstantInt::get(intPtrTy, 0), peelGuard);
+
+  // continue edge of the peel latch -> peelNext
+  auto * peelLatchTerm = peelLatch.getTerminator();
+  for (size_t i = 0; i < peelLatchTerm->getNumSuccessors(); ++i) {
+    if (peelLatchTerm->getSuccessor(i) == &peelHeader) peelLatchTerm->setSuccessor(i, peelNext);
+  }
+  for (auto & inst : peelHeader) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) break;
+    if (phi == peelCounter) continue;
+    phi->replaceIncomingBlockWith(preHeader, peelGuard);
+    phi->replaceIncomingBlockWith(&peelLatch, peelNext);
+  }
+
+  IRBuilder<> nextBuilder(peelNext);
+  auto * nextCounter = nextBuilder.CreateAdd(peelCounter, ConstantInt::get(intPtrTy, 1), loopName + ".peelcnt.next", true, true);
+  peelCounter->addIncoming(nextCounter, peelNext);
+  auto * peelDone = nextBuilder.CreateICmpEQ(nextCounter, numPeel);
+  nextBuilder.CreateCondBr(peelDone, afterPeel, &peelHeader);
+
+// start the loop where the peel loop stopped
+  IRBuilder<> afterBuilder(afterPeel);
+  for (auto & inst : *header) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) break;
+
+    int initIdx = phi->getBasicBlockIndex(preHeader);
+    auto * initVal = phi->getIncomingValue(initIdx);
+    auto & peelPhi = cast<PHINode>(LookUp(cloneMap, *phi));
+    auto * peelVal = peelPhi.getIncomingValueForBlock(peelNext);
+
+    auto * startPhi = afterBuilder.CreatePHI(phi->getType(), 2, phi->getName().str() + ".peeled");
+    startPhi->addIncoming(initVal, peelGuard);
+    startPhi->addIncoming(peelVal, peelNext);
+
+    phi->setIncomingBlock(initIdx, afterPeel);
+    phi->setIncomingValue(initIdx, startPhi);
+  }
+  afterBuilder.CreateBr(header);
+
+// the peel loop may leave the loop directly
+  for (auto & inst : *exitBlock) {
+    auto * phi = dyn_cast<PHINode>(&inst);
+    if (!phi) break;
+    auto * exitVal = phi->getIncomingValueForBlock(exiting);
+    auto itMapped = cloneMap.find(exitVal);
+    phi->addIncoming(itMapped != cloneMap.end() ? (Value*) itMapped->second : exitVal, &peelLatch);
+  }
+
+  DT.recalculate(F);
+  PDT.recalculate(F);
+  SE.forgetLoop(&L);
+
+  // the vector loop starts on an aligned address
+  SetAlignmentHint(*alignedInst, vectorBytes);
+  return true;
+}
+
+} // namespace rv
@@ -2,6 +2,8 @@
 
 #include "rv/config.h"
 
+#include <limits>
+
 using namespace llvm;
 
 namespace rv {
@@ -39,6 +41,8 @@ CreateReductInst(IRBuilder<> & builder, RedKind redKind, Value & firstArg, Value
         return *cast<Instruction>(builder.CreateOr(&firstArg, &secondArg, secondArg.getName() + ".r"));
     case RedKind::And:
         return *cast<Instruction>(builder.CreateAnd(&firstArg, &secondArg, secondArg.getName() + ".r"));
+    case RedKind::Xor:
+        return *cast<Instruction>(builder.CreateXor(&firstArg, &secondArg, secondArg.getName() + ".r"));
 
     case RedKind::Mul:
       if (isFloat) {
@@ -99,6 +103,7 @@ GetIntrinsicID(RedKind kind, Type & elemTy, bool &oHasInitVal) {
     }
     case RedKind::And: return Intrinsic::vector_reduce_and;
     case RedKind::Or: return Intrinsic::vector_reduce_or;
+    case RedKind::Xor: return Intrinsic::vector_reduce_xor;
     case RedKind::SMax: return elemTy.isFloatingPointTy() ? Intrinsic::vector_reduce_fmax : Intrinsic::vector_reduce_smax;
     case RedKind::UMax: return elemTy.isFloatingPointTy() ? Intrinsic::vector_reduce_fmax : Intrinsic::vector_reduce_umax;
     case RedKind::SMin: return elemTy.isFloatingPointTy() ? Intrinsic::vector_reduce_fmin : Intrinsic::vector_reduce_smin;
@@ -108,7 +113,7 @@ GetIntrinsicID(RedKind kind, Type & elemTy, bool &oHasInitVal) {
 
 // reduce the vector @vectorVal to a scalar value (using redKind)
 Value &
-CreateVectorReduce(Config & config, IRBuilder<> & builder, RedKind redKind, Value & vecVal, Value * initVal) {
+CreateVectorReduce(Config & config, IRBuilder<> & builder, RedKind redKind, Value & vecVal, Value * initVal, ReductionMode mode) {
   auto & vecTy = *cast<FixedVectorType>(vecVal.getType());
   unsigned vecWidth = vecTy.getNumElements();
   auto & elemTy = *vecTy.getElementType();
@@ -120,9 +125,15 @@ CreateVectorReduce(Config & config, IRBuilder<> & builder, RedKind redKind, Valu
     useFallback = true;
   }
 
-// use LLVM's experimental intrinsics where possible
+  // only the scalar chain (or the strict fadd/fmul intrinsics) preserve the lane order
+  bool ordered = (mode == ReductionMode::Ordered) && elemTy.isFloatingPointTy();
   bool hasInitValArg = false; // whether the intrinsic has an initial value argument
   Intrinsic::ID ID = GetIntrinsicID(redKind, elemTy, hasInitValArg);
+  if (mode == ReductionMode::Tree || (ordered && !hasInitValArg)) {
+    useFallback = true;
+  }
+
+// use LLVM's experimental intrinsics where possible
   if (!useFallback && (ID != Intrinsic::not_intrinsic)) {
     auto & mod = *builder.GetInsertBlock()->getParent()->getParent();
 
@@ -132,13 +143,23 @@ CreateVectorReduce(Config & config, IRBuilder<> & builder, RedKind redKind, Valu
 
     Value * redVal = nullptr;
 
+    // let the backend reassociate the lanes (otw, fadd/fmul reduce in lane order)
+    FastMathFlags FMF;
+    if (mode == ReductionMode::Intrinsic && elemTy.isFloatingPointTy()) {
+      FMF.setAllowReassoc();
+    }
+
     if (hasInitValArg) {
       Value * initArg = initVal ? initVal : &GetNeutralElement(redKind, elemTy);
-      return *builder.CreateCall(&redFunc, {initArg, &vecVal}, "red" + to_string(redKind));
+      auto * redCall = builder.CreateCall(&redFunc, {initArg, &vecVal}, "red" + to_string(redKind));
+      if (FMF.any()) redCall->setFastMathFlags(FMF);
+      return *redCall;
     }
 
     assert(!hasInitValArg);
-    redVal = builder.CreateCall(&redFunc, &vecVal, "red" + to_string(redKind));
+    auto * redCall = builder.CreateCall(&redFunc, &vecVal, "red" + to_string(redKind));
+    if (FMF.any()) redCall->setFastMathFlags(FMF);
+    redVal = redCall;
     // add init val (if applicable)
     if (initVal && initVal != &GetNeutralElement(redKind, elemTy)) {
       return CreateReductInst(builder, redKind, *redVal, *initVal);
@@ -149,7 +170,7 @@ CreateVectorReduce(Config & config, IRBuilder<> & builder, RedKind redKind, Valu
 
 // Otw, use fallback code path
   auto * intTy = Type::getInt32Ty(builder.getContext());
-  if (IsPower2(vecWidth)) {
+  if (IsPower2(vecWidth) && !ordered) {
     auto * accu = &vecVal;
     for (size_t range = vecWidth / 2; range >= 1; range /= 2) {
       // create a permutation vector
@@ -194,6 +215,63 @@ CreateVectorReduce(Config & config, IRBuilder<> & builder, RedKind redKind, Valu
   }
 }
 
+// inclusive prefix scan of the lanes of @vecVal (using redKind)
+Value &
+CreateVectorScan(IRBuilder<> & builder, RedKind redKind, Value & vecVal) {
+  auto & vecTy = *cast<FixedVectorType>(vecVal.getType());
+  unsigned vecWidth = vecTy.getNumElements();
+  auto * intTy = Type::getInt32Ty(builder.getContext());
+  auto & neutral = GetNeutralElement(redKind, *vecTy.getElementType());
+  auto * neutralVec = builder.CreateVectorSplat(vecWidth, &neutral);
+
+  auto * accu = &vecVal;
+  for (unsigned dist = 1; dist < vecWidth; dist *= 2) {
+    // shift the partial sums up by dist lanes (neutral elements enter the lower lanes)
+    // dist == 2: n n 0 1 2 3 4 5
+    std::vector<Constant*> shuffleVec;
+    shuffleVec.reserve(vecWidth);
+    for (unsigned i = 0; i < vecWidth; ++i) {
+      shuffleVec.push_back(ConstantInt::get(intTy, i < dist ? vecWidth + i : i - dist));
+    }
+
+    auto * mask = ConstantVector::get(shuffleVec);
+    auto * shifted = builder.CreateShuffleVector(accu, neutralVec, mask, "scan.shift");
+    accu = &CreateReductInst(builder, redKind, *accu, *shifted);
+  }
+
+  return *accu;
+}
+
+// pick the payload of the first/last iteration among the candidate lanes
+Value &
+CreatePayloadReduce(Config & config, IRBuilder<> & builder, Value & payloadVec, Value & stampVec, Value * candMask, bool pickFirst) {
+  auto & stampVecTy = *cast<FixedVectorType>(stampVec.getType());
+  unsigned vecWidth = stampVecTy.getNumElements();
+  auto * stampTy = stampVecTy.getElementType();
+  auto * intTy = Type::getInt32Ty(builder.getContext());
+
+  // lanes that do not hold the key result never win
+  Value * stamps = &stampVec;
+  if (candMask) {
+    int64_t noStamp = pickFirst ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+    auto * noStampVec = builder.CreateVectorSplat(vecWidth, ConstantInt::get(stampTy, noStamp, true));
+    stamps = builder.CreateSelect(candMask, stamps, noStampVec, "stamp.cand");
+  }
+  auto & bestStamp = CreateVectorReduce(config, builder, pickFirst ? RedKind::SMin : RedKind::SMax, *stamps, nullptr);
+
+  // lowest lane with that stamp (lanes that never updated share the initial payload)
+  auto * bestMask = builder.CreateICmpEQ(stamps, builder.CreateVectorSplat(vecWidth, &bestStamp), "stamp.best");
+  std::vector<Constant*> laneIds;
+  for (unsigned i = 0; i < vecWidth; ++i) {
+    laneIds.push_back(ConstantInt::get(intTy, i));
+  }
+  auto * noLaneVec = builder.CreateVectorSplat(vecWidth, ConstantInt::get(intTy, vecWidth));
+  auto * bestLanes = builder.CreateSelect(bestMask, ConstantVector::get(laneIds), noLaneVec, "lane.best");
+  auto & bestLane = CreateVectorReduce(config, builder, RedKind::UMin, *bestLanes, nullptr);
+
+  return *builder.CreateExtractElement(&payloadVec, &bestLane, payloadVec.getName() + ".pick");
+}
+
 Value &
 CreateExtract(IRBuilder<> & builder, Value & vecVal, int laneOffset) {
   auto * vecTy = dyn_cast<VectorType>(vecVal.getType());
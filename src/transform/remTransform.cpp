@@ -23,6 +23,7 @@
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Transforms/Utils/Local.h"
 
 #include "rvConfig.h"
 #include "rv/rvDebug.h"
@@ -80,6 +81,22 @@ public:
   bool
   exitsOnTrue() const { return loopExitOnTrue; }
 
+  // the loop exit comparison and the index of its loop carried operand
+  CmpInst & getCmp() const { return cmp; }
+  int getCarriedOperandIdx() const { return cmpReductIdx; }
+
+  // the stride pattern of the tested iteration variable
+  StridePattern & getStridePattern() const { return sp; }
+
+  // predicate for the loop exit comparison that is monotone in the iteration variable
+  // (same branch orientation as the original comparison)
+  CmpInst::Predicate
+  getMonotonePredicate() const {
+    // equalities were legalized assuming the carried operand on the lhs
+    if (cmp.isEquality() && cmpReductIdx == 1) return CmpInst::getSwappedPredicate(adjustedPred);
+    return adjustedPred;
+  }
+
   BranchCondition(bool _loopExitOnTrue, bool _exitWhenEqual, llvm::CmpInst & _cmp, CmpInst::Predicate _adjustedPred, int _cmpReductIdx, StridePattern & _sp, int vectorWidth)
   : loopExitOnTrue(_loopExitOnTrue)
   , exitWhenEqual(_exitWhenEqual)
@@ -839,6 +856,196 @@ struct LoopTransformer {
   }
 };
 
+// turns a loop into a predicated loop that executes @vectorWidth iterations per vector iteration
+//
+// - original loop -
+//
+//  header <--.
+//    |       |
+//   ...      |
+//    |       |
+//  latch ----' (exiting)
+//
+// - predicated loop -
+//
+//  header <-----.      // header phis, stride increments and the lane guard (iteration executes in the scalar loop)
+//    |     \     |
+//  body     |    |     // predicated by the lane guard
+//   ...     |    |
+//    |     /     |
+//  predlatch ----'     // blends loop carried values, uniform exit test for the next vector iteration
+//
+struct LoopPredicator {
+  Function & F;
+  DominatorTree & DT;
+  PostDominatorTree & PDT;
+  LoopInfo & LI;
+  ReductionAnalysis & reda;
+  std::set<Value*> & uniOverrides;
+
+  Loop & L;
+  BranchCondition & exitCond;
+  int vectorWidth;
+
+  LoopPredicator(Function & _F, DominatorTree & _DT, PostDominatorTree & _PDT, LoopInfo & _LI, ReductionAnalysis & _reda, std::set<Value*> & _uniOverrides, BranchCondition & _exitCond, Loop & _L, int _vectorWidth)
+  : F(_F)
+  , DT(_DT)
+  , PDT(_PDT)
+  , LI(_LI)
+  , reda(_reda)
+  , uniOverrides(_uniOverrides)
+  , L(_L)
+  , exitCond(_exitCond)
+  , vectorWidth(_vectorWidth)
+  {}
+
+  // the latch value of @phi if it is part of a reduction
+  Instruction*
+  getReductionLatchValue(PHINode & phi) {
+    if (!reda.getReductionInfo(phi)) return nullptr;
+    int latchIdx = phi.getBasicBlockIndex(L.getLoopLatch());
+    return dyn_cast<Instruction>(phi.getIncomingValue(latchIdx));
+  }
+
+  // loop live outs must be the latch values of reductions (they can be blended safely)
+  bool
+  canPredicate() {
+    if (!exitCond.getStridePattern().phi->getType()->isIntegerTy()) {
+      Report() << "remTrans: can not predicate loop with a non-integer iteration variable\n";
+      return false;
+    }
+
+    std::set<Instruction*> blendableLiveOuts;
+    for (auto & inst : *L.getHeader()) {
+      auto * phi = dyn_cast<PHINode>(&inst);
+      if (!phi) break;
+      auto * latchVal = getReductionLatchValue(*phi);
+      if (latchVal) blendableLiveOuts.insert(latchVal);
+    }
+
+    for (auto * BB : L.blocks()) {
+      for (auto & inst : *BB) {
+        for (auto * user : inst.users()) {
+          auto * userInst = cast<Instruction>(user);
+          if (L.contains(userInst->getParent())) continue;
+          if (blendableLiveOuts.count(&inst)) continue;
+
+          Report() << "remTrans: can not predicate loop with live out " << inst << "\n";
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  // synthesize the loop exit test as it evaluates at the end of the iteration @iterOffset iterations after the current one
+  Value &
+  synthesizeExitTest(int iterOffset, std::string suffix, IRBuilder<> & builder) {
+    auto & sp = exitCond.getStridePattern();
+    auto & cmp = exitCond.getCmp();
+    auto * incTy = sp.phi->getType();
+
+    auto createIteration = [&](int64_t offset) -> Value* {
+      if (offset == 0) return sp.phi;
+      // looking back may leave the iteration space (no wrap flags)
+      bool keepFlags = offset > 0;
+      return builder.CreateAdd(sp.phi, ConstantInt::get(incTy, offset * sp.inc, true), sp.phi->getName().str() + suffix,
+                               keepFlags && sp.reductor->hasNoUnsignedWrap(), keepFlags && sp.reductor->hasNoSignedWrap());
+    };
+
+    ValueToValueMapTy replMap;
+    auto & testVal = LoopTransformer::ReplicateExpression(suffix, cmp, replMap,
+        [&](Instruction & inst, IRBuilder<>&) -> Value* {
+          // loop invariant value
+          if (!L.contains(inst.getParent())) return &inst;
+
+          // the iteration variable
+          if (&inst == sp.phi) return createIteration(iterOffset);
+          if (&inst == sp.reductor) return createIteration(iterOffset + 1);
+
+          // Otw, copy that operation
+          return nullptr;
+        },
+      builder);
+
+    cast<CmpInst>(testVal).setPredicate(exitCond.getMonotonePredicate());
+    return testVal;
+  }
+
+  void
+  run() {
+    auto & header = *L.getHeader();
+    auto & exiting = *L.getExitingBlock();
+    auto * preHeader = L.getLoopPreheader();
+    std::string loopName = L.getName().str();
+
+  // split off the loop exit branch and the region that will be predicated
+    auto * latchBlock = exiting.splitBasicBlock(exiting.getTerminator(), loopName + ".predlatch");
+    L.addBasicBlockToLoop(latchBlock, LI);
+    auto * bodyBlock = header.splitBasicBlock(header.getFirstNonPHI(), loopName + ".predbody");
+    L.addBasicBlockToLoop(bodyBlock, LI);
+    auto * predExiting = latchBlock->getSinglePredecessor();
+
+  // stride increments are computed for all lanes
+    for (auto & inst : header) {
+      auto * phi = dyn_cast<PHINode>(&inst);
+      if (!phi) break;
+      auto * sp = reda.getStrideInfo(*phi);
+      if (sp) sp->reductor->moveBefore(header.getTerminator());
+    }
+
+  // blend the reduction values of inactive lanes in the latch
+    IRBuilder<> latchBuilder(latchBlock, latchBlock->begin());
+    for (auto & inst : header) {
+      auto * phi = dyn_cast<PHINode>(&inst);
+      if (!phi) break;
+      auto * latchVal = getReductionLatchValue(*phi);
+      if (!latchVal || !L.contains(latchVal->getParent()) || latchVal->getParent() == &header) continue;
+
+      auto * blendPhi = latchBuilder.CreatePHI(phi->getType(), 2, latchVal->getName().str() + ".blend");
+      blendPhi->addIncoming(latchVal, predExiting);
+      blendPhi->addIncoming(phi, &header);
+
+      latchVal->replaceUsesWithIf(blendPhi, [&](Use & use) {
+        auto * userInst = cast<Instruction>(use.getUser());
+        return userInst != blendPhi && (userInst->getParent() == &header || !L.contains(userInst->getParent()));
+      });
+    }
+
+  // lane guard: the iteration executes in the scalar loop if the previous iteration did not exit
+    IRBuilder<> headerBuilder(header.getTerminator());
+    auto & sp = exitCond.getStridePattern();
+    auto & prevExitVal = synthesizeExitTest(-1, ".prev", headerBuilder);
+    auto * prevStays = exitCond.exitsOnTrue() ? headerBuilder.CreateNot(&prevExitVal) : &prevExitVal;
+    // the first iteration always executes
+    auto * initVal = sp.phi->getIncomingValueForBlock(preHeader);
+    auto * isFirst = headerBuilder.CreateICmpEQ(sp.phi, initVal, loopName + ".first");
+    auto * laneGuard = headerBuilder.CreateOr(isFirst, prevStays, loopName + ".active");
+
+    header.getTerminator()->eraseFromParent();
+    BranchInst::Create(bodyBlock, latchBlock, laneGuard, &header);
+
+  // uniform exit test: continue while the first lane of the next vector iteration is active
+    auto & latchBr = *cast<BranchInst>(latchBlock->getTerminator());
+    auto * oldCond = dyn_cast<Instruction>(latchBr.getCondition());
+
+    IRBuilder<> exitBuilder(&latchBr);
+    auto & nextExitVal = synthesizeExitTest(vectorWidth - 1, ".predExit", exitBuilder);
+    latchBr.setCondition(&nextExitVal);
+
+    for (auto & inst : *latchBlock) {
+      if (isa<PHINode>(inst) || inst.isTerminator()) continue;
+      uniOverrides.insert(&inst);
+    }
+
+    if (oldCond) RecursivelyDeleteTriviallyDeadInstructions(oldCond);
+
+    DT.recalculate(F);
+    PDT.recalculate(F);
+  }
+};
+
 BranchCondition*
 RemainderTransform::analyzeExitCondition(llvm::Loop & L, int vectorWidth) {
   auto * loopExiting = L.getExitingBlock();
@@ -924,6 +1131,14 @@ RemainderTransform::createVectorizableLoop(Loop & L, ValueSet & uniOverrides, in
 #endif
   auto & clonedLoop = cloneInfo.clonedLoop;
 
+  // the vector loop keeps the block names of the scalar loop (lane profiles and the width cost model refer to them)
+  for (auto * scalarBlock : L.blocks()) {
+    auto & clonedBlock = LookUp(cloneMap, *scalarBlock);
+    std::string clonedName = clonedBlock.getName().str();
+    clonedBlock.takeName(scalarBlock);
+    scalarBlock->setName(clonedName);
+  }
+
   // reda.updateForClones(LI, cloneMap);
 
 // embed the cloned loop
@@ -942,4 +1157,39 @@ RemainderTransform::createVectorizableLoop(Loop & L, ValueSet & uniOverrides, in
   return &clonedLoop;
 }
 
+Loop*
+RemainderTransform::createPredicatedLoop(Loop & L, ValueSet & uniOverrides, int vectorWidth) {
+  // re-analyze (the remainder loop of a vector loop may be predicated)
+  reda.analyze(L);
+
+// run capability checks
+  if (!canTransformLoop(L)) return nullptr;
+
+  auto * branchCond = analyzeExitCondition(L, vectorWidth);
+  if (!branchCond) {
+    Report() << "remTrans: can not handle loop exit condition\n";
+    return nullptr;
+  }
+
+  LoopPredicator loopPred(F, DT, PDT, LI, reda, uniOverrides, *branchCond, L, vectorWidth);
+  if (!loopPred.canPredicate()) {
+    delete branchCond;
+    return nullptr;
+  }
+
+// predicate the loop in place
+  loopPred.run();
+  delete branchCond;
+
+  // rebuild reduction information for the predicated loop
+  reda.analyze(L);
+
+  IF_DEBUG_REM {
+    errs() << "-- function after loop predication --\n";
+    Dump(F);
+  }
+
+  return &L;
+}
+
 } // namespace rv
@@ -61,11 +61,15 @@ namespace rv {
 typedef std::vector<llvm::Value*> ValVec;
 typedef std::map<llvm::Value*, ValVec> MultiValMap;
 typedef std::vector<Type*> TypeVec;
+typedef SmallPtrSet<const Instruction*, 32> ConstInstSet;
 
 struct
 ReplicateMap {
   VectorizationInfo & vecInfo;
 
+  // instructions whose shapes have to be updated after the transformation
+  ConstInstSet & updateSet;
+
   // maps original values to scalar replicates
   MultiValMap replMap;
 
@@ -79,6 +83,7 @@ ReplicateMap {
       auto * replInst = dyn_cast<Instruction>(val);
       if (!replInst) continue;
       vecInfo.setVectorShape(*replInst, aggregateShape);
+      updateSet.insert(replInst);
     }
 
     replMap[&val] = scalarRepls;
@@ -90,8 +95,9 @@ ReplicateMap {
 
   size_t size() const { return replMap.size(); }
 
-  ReplicateMap(VectorizationInfo & _vecInfo)
+  ReplicateMap(VectorizationInfo & _vecInfo, ConstInstSet & _updateSet)
   : vecInfo(_vecInfo)
+  , updateSet(_updateSet)
   {}
 };
 
@@ -103,6 +109,9 @@ struct Impl {
   VectorizationInfo & vecInfo;
   const PlatformInfo & platInfo;
 
+  // new (and re-used) instructions with a tentative shape (the aggregate shape)
+  ConstInstSet updateSet;
+
   // maps aggregates to their scalar replications
   ReplicateMap replMap;
 
@@ -112,7 +121,7 @@ Impl(Function & _F, VectorizationInfo & _vecInfo, const PlatformInfo & _platInfo
 : F(_F)
 , vecInfo(_vecInfo)
 , platInfo(_platInfo)
-, replMap(_vecInfo)
+, replMap(_vecInfo, updateSet)
 {}
 
 // all instructions are mapped
@@ -223,6 +232,7 @@ Value * reaggregateInstruction(IRBuilder<> & builder, const ValVec & replVec, Ty
       auto elemVal = reaggregateInstruction(builder, replVec, aggTy->getStructElementType(i), vecShape, index);
       aggVal = builder.CreateInsertValue(aggVal, elemVal, i);
       vecInfo.setVectorShape(*aggVal, vecShape);
+      if (auto * aggInst = dyn_cast<Instruction>(aggVal)) updateSet.insert(aggInst);
     }
     return aggVal;
   } else if (aggTy->isVectorTy()) {
@@ -232,6 +242,7 @@ Value * reaggregateInstruction(IRBuilder<> & builder, const ValVec & replVec, Ty
     for (size_t i = 0; i < n; i++) {
       aggVal = builder.CreateInsertElement(aggVal, replVec[i], ConstantInt::get(Type::getInt32Ty(builder.getContext()), i));
       vecInfo.setVectorShape(*aggVal, vecShape);
+      if (auto * aggInst = dyn_cast<Instruction>(aggVal)) updateSet.insert(aggInst);
     }
     return aggVal;
 
@@ -301,6 +312,7 @@ finalize() {
 
     // all uses patched -> erase
     vecInfo.dropVectorShape(*inst);
+    updateSet.erase(inst);
     inst->eraseFromParent();
   }
 
@@ -445,6 +457,7 @@ size_t flattenedLoadStore(IRBuilder<> & builder, Value * ptr, ValVec & replVec,
       // load every member
       auto * elemGep = builder.CreateGEP(ptr, {ConstantInt::get(intTy, 0, true), ConstantInt::get(intTy, i, true)}, "srov_gep");
       vecInfo.setVectorShape(*elemGep, ptrShape); // FIXME alignment
+      if (auto * gepInst = dyn_cast<Instruction>(elemGep)) updateSet.insert(gepInst);
       flatIdx = flattenedLoadStore(builder, elemGep, replVec, flatIdx, load, store);
     }
     return flatIdx;
@@ -456,11 +469,13 @@ size_t flattenedLoadStore(IRBuilder<> & builder, Value * ptr, ValVec & replVec,
     auto * scaPtrTy = PointerType::get(cast<FixedVectorType>(ptrTy->getPointerElementType())->getElementType(), ptrTy->getPointerAddressSpace());
     auto * scaPtr = builder.CreatePointerCast(ptr, scaPtrTy);
     vecInfo.setVectorShape(*scaPtr, ptrShape);
+    if (auto * castInst = dyn_cast<Instruction>(scaPtr)) updateSet.insert(castInst);
 
     for (size_t i = 0; i < n; i++) {
       // load every member
       auto * elemGep = i > 0 ? builder.CreateGEP(scaPtr, ConstantInt::get(intTy, i, true), "srov_gep") : scaPtr;
       vecInfo.setVectorShape(*elemGep, ptrShape); // FIXME alignment
+      if (auto * gepInst = dyn_cast<Instruction>(elemGep)) updateSet.insert(gepInst);
       flatIdx = flattenedLoadStore(builder, elemGep, replVec, flatIdx, load, store);
     }
     return flatIdx;
@@ -472,6 +487,7 @@ size_t flattenedLoadStore(IRBuilder<> & builder, Value * ptr, ValVec & replVec,
       assert(replVec.size() == flatIdx);
       auto * flatLoad = builder.CreateLoad(ptr, load->isVolatile());
       vecInfo.setVectorShape(*flatLoad, vecInfo.getVectorShape(*load));
+      updateSet.insert(flatLoad);
       replVec.push_back(flatLoad);
     }
     if (store) {
@@ -479,6 +495,7 @@ size_t flattenedLoadStore(IRBuilder<> & builder, Value * ptr, ValVec & replVec,
       assert(replVec.size() > flatIdx);
       auto * flatStore = builder.CreateStore(replVec[flatIdx], ptr, store->isVolatile());
       vecInfo.setVectorShape(*flatStore, vecInfo.getVectorShape(*store));
+      updateSet.insert(flatStore);
     }
     return flatIdx + 1;
   }
@@ -861,7 +878,9 @@ SROVTransform::SROVTransform(VectorizationInfo & _vecInfo, const PlatformInfo &
 bool
 SROVTransform::run() {
   Impl impl(vecInfo.getScalarFunction(), vecInfo, platInfo);
-  return impl.run();
+  bool changed = impl.run();
+  updateList.assign(impl.updateSet.begin(), impl.updateSet.end());
+  return changed;
 }
 
 }
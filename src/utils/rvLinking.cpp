@@ -1,4 +1,6 @@
 #include "utils/rvLinking.h"
+#include "utils/rvTools.h"
+#include "report.h"
 
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/Constants.h>
@@ -78,6 +80,11 @@ Function &cloneFunctionIntoModule(Function &func, Module &cloneInto, StringRef n
                                         name, &cloneInto);
   clonedFn.copyAttributesFrom(&func);
 
+  // lazily loaded source module (SLEEF) - parse the body now
+  std::string materializeError;
+  if (!materializeLazyFunction(func, materializeError))
+    fail("could not load " + func.getName().str() + " for linking: " + materializeError);
+
   // external decl
   if (func.isDeclaration()) return clonedFn;
 
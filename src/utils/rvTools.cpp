@@ -26,6 +26,7 @@
 #include <llvm/IR/Value.h>
 
 #include <llvm/IRReader/IRReader.h>
+#include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/MemoryBuffer.h> // MemoryBuffer
 #include <llvm/Support/SourceMgr.h>
@@ -148,6 +149,29 @@ Module *createModuleFromBuffer(const char buffer[], size_t length,
   return modPtr.release();
 }
 
+Module *createLazyModuleFromBuffer(const char buffer[], size_t length,
+                                   LLVMContext &context) {
+  // the buffer outlives the module (static bitcode blob) - no need to copy it
+  MemoryBufferRef mbRef(StringRef(buffer, length), "");
+  auto modOrErr = getLazyBitcodeModule(mbRef, context);
+  if (!modOrErr) {
+    errs() << "rv::createLazyModuleFromBuffer: "
+           << toString(modOrErr.takeError()) << "\n";
+    return nullptr;
+  }
+  return modOrErr->release();
+}
+
+bool materializeLazyFunction(Function &func, std::string &oErrorText) {
+  if (!func.isMaterializable())
+    return true;
+  if (Error err = func.materialize()) {
+    oErrorText = toString(std::move(err));
+    return false;
+  }
+  return true;
+}
+
 Module *createModuleFromFile(const std::string &fileName,
                              LLVMContext &context) {
   SMDiagnostic smDiag;
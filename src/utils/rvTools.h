@@ -69,6 +69,15 @@ createModuleFromFile(const std::string & fileName, LLVMContext & context);
 Module*
 createModuleFromBuffer(const char buffer[], size_t length, LLVMContext & context);
 
+// returns a module that only parses function bodies on demand (see materializeLazyFunction).
+// \p buffer has to hold bitcode and must outlive the module.
+Module*
+createLazyModuleFromBuffer(const char buffer[], size_t length, LLVMContext & context);
+
+// parse the body of \p func if it is still lazily deferred (returns false and sets \p oErrorText on error).
+bool
+materializeLazyFunction(Function & func, std::string & oErrorText);
+
 void
 writeModuleToFile(const Module& mod, const std::string& fileName);
 
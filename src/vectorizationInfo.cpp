@@ -250,6 +250,53 @@ VectorizationInfo::forgetInferredProperties() {
   }
 }
 
+void
+VectorizationInfo::copyInferredProperties(const VectorizationInfo & srcInfo,
+                                          const ValueToValueMapTy & cloneMap,
+                                          const LoopInfo & destLI) {
+  auto lookupBlock = [&](const BasicBlock * srcBlock) -> const BasicBlock* {
+    auto it = cloneMap.find(srcBlock);
+    if (it == cloneMap.end()) return nullptr;
+    return cast<BasicBlock>(it->second);
+  };
+
+  // shapes (values outside of the cloned function are shared)
+  for (auto & itValShape : srcInfo.shapes) {
+    const Value * srcVal = itValShape.first;
+    if (srcInfo.pinned.count(srcVal)) continue;
+
+    const Value * destVal = srcVal;
+    auto itMapped = cloneMap.find(srcVal);
+    if (itMapped != cloneMap.end()) {
+      destVal = itMapped->second;
+    } else if (isa<Instruction>(srcVal) || isa<Argument>(srcVal) || isa<BasicBlock>(srcVal)) {
+      continue;
+    }
+
+    if (!destVal || pinned.count(destVal)) continue;
+    shapes[destVal] = itValShape.second;
+  }
+
+  // block properties
+  for (auto * srcBlock : srcInfo.DivergentLoopExits) {
+    if (auto * destBlock = lookupBlock(srcBlock)) DivergentLoopExits.insert(destBlock);
+  }
+  for (auto * srcBlock : srcInfo.JoinDivergentBlocks) {
+    if (auto * destBlock = lookupBlock(srcBlock)) JoinDivergentBlocks.insert(destBlock);
+  }
+  for (auto & itBlockFlag : srcInfo.VaryingPredicateBlocks) {
+    if (auto * destBlock = lookupBlock(itBlockFlag.first)) VaryingPredicateBlocks[destBlock] = itBlockFlag.second;
+  }
+
+  // divergent loops (identified by their headers)
+  for (auto * srcLoop : srcInfo.mDivergentLoops) {
+    auto * destHeader = lookupBlock(srcLoop->getHeader());
+    if (!destHeader) continue;
+    auto * destLoop = destLI.getLoopFor(destHeader);
+    if (destLoop) mDivergentLoops.insert(destLoop);
+  }
+}
+
 void VectorizationInfo::dropVectorShape(const Value &val) {
   auto it = shapes.find(&val);
   if (it == shapes.end())
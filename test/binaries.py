@@ -50,6 +50,7 @@ def runForOutput(cmdText):
         return False, err.output
 
 rvToolLine="rvTool"
+optLine="opt -enable-new-pm=0"
 
 # use a 1.0 ULP error bound for SLEEF math
 testULPBound = 10
@@ -77,7 +78,7 @@ def rvToolOuterLoop(scalarLL, destFile, scalarName = "foo", options = {}, logPre
     if 0 < len(options['extraShapes'].items()):
       cmd = cmd + " -x " + ",".join("{}={}".format(k,v) for k,v in options['extraShapes'].items())
 
-    return shellCmd(cmd,  None, logPrefix)
+    return shellCmd(cmd,  options['env'], logPrefix)
 
 def rvToolWFV(scalarLL, destFile, scalarName = "foo", options = {}, logPrefix=None):
     cmd = rvToolLine + " -wfv -lower -i " + scalarLL
@@ -96,7 +97,12 @@ def rvToolWFV(scalarLL, destFile, scalarName = "foo", options = {}, logPrefix=No
 
     cmd += " --math-prec {}".format(testULPBound)
 
-    return shellCmd(cmd,  None, logPrefix)
+    return shellCmd(cmd,  options['env'], logPrefix)
+
+# vectorize the annotated loops of @scalarLL with the RV loop vectorizer pass (instead of rvTool's first loop)
+def rvOptLoopVec(scalarLL, destFile, options = {}, logPrefix=None):
+    cmd = optLine + " -O2 -rv-loopvec -vectorize-loops=false -vectorize-slp=false -S " + scalarLL + " -o " + destFile
+    return shellCmd(cmd,  options['env'], logPrefix)
 
 
 
@@ -149,8 +155,15 @@ class LLVMTools(object):
     if srcFile[-2:] == ".c":
       retCode = shellCmd(self.cClangLine + " " + srcFile + " -fno-unroll-loops -S -emit-llvm -c " + extraFlags + " -o " + destFile)
     else:
-      retCode = shellCmd(self.clangLine + " " + srcFile + " -fno-unroll-loops -S -emit-llvm -c " + extraFlags + "-o " + destFile)
+      retCode = shellCmd(self.clangLine + " " + srcFile + " -fno-unroll-loops -S -emit-llvm -c " + extraFlags + " -o " + destFile)
     return retCode == 0
+
+  # un-optimized IR that keeps the loop annotations for the RV loop vectorizer pass
+  def compileToRawIR(self, srcFile, destFile, extraFlags=""):
+    if not path.exists(srcFile):
+      return False
+    compilerLine = self.cClangLine if srcFile[-2:] == ".c" else self.clangLine
+    return 0 == shellCmd(compilerLine + " " + srcFile + " -fno-unroll-loops -Xclang -disable-llvm-passes -S -emit-llvm -c " + extraFlags + " -o " + destFile)
   
   def disassemble(self, bcFile, suffix):
       return shellCmd("llvm-dis " + bcFile, "logs/dis_" + suffix) == 0
@@ -25,6 +25,8 @@ hashArray(D * data, int n, size_t accu)  {
 
 typedef __attribute__((ext_vector_type(8))) float float8;
 typedef __attribute__((ext_vector_type(8))) int int8;
+typedef __attribute__((ext_vector_type(16))) float float16;
+typedef __attribute__((ext_vector_type(16))) int int16;
 
 static float
 wfvRand() {
@@ -78,6 +80,12 @@ static void toArray4(V v, S * r) {
   r[2] = v.s2;
   r[3] = v.s3;
 }
+
+template<typename S, typename V>
+static void toArray16(V v, S * r) {
+  toArray<S>(v.lo, r);
+  toArray<S>(v.hi, r + 8);
+}
 template<typename S>
 static void dumpArray(S * A, uint n) {
   if (n == 0) return;
@@ -0,0 +1,31 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" int foo(float * A, float * B, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const uint n = 8 * 800 + 5;
+
+  float * A = new float[n];
+  for (uint i = 0; i < n; ++i) {
+    A[i] = wfvRand();
+  }
+  float * B = new float[n]();
+
+  int k = foo(A, B, n);
+
+  size_t hash = hashArray(B, k, 0);
+  delete [] A;
+  delete [] B;
+
+  std::cerr << k << " " << hash << "\n";
+
+  return 0;
+}
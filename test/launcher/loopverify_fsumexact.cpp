@@ -0,0 +1,28 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" float foo(float * A, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const int n = 8 * 100 + 5;
+
+  // multiples of 1/4 that sum up without rounding in any order
+  float * A = new float[n];
+  for (int i = 0; i < n; ++i) {
+    A[i] = (rand() % 2001 - 1000) / 4.0f;
+  }
+
+  float s = foo(A, n);
+  delete [] A;
+
+  std::cerr << std::hexfloat << s << "\n";
+
+  return 0;
+}
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" void foo(float * A, int * Idx, float * B, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const int n = 8 * 100 + 5;
+
+  float * A = new float[n];
+  float * B = new float[n];
+  for (int i = 0; i < n; ++i) {
+    A[i] = wfvRand();
+    B[i] = wfvRand();
+  }
+
+  // a permutation (the scattered lanes must not collide)
+  int * Idx = new int[n];
+  for (int i = 0; i < n; ++i) {
+    Idx[i] = i;
+  }
+  for (int i = n - 1; i > 0; --i) {
+    int j = rand() % (i + 1);
+    int t = Idx[i];
+    Idx[i] = Idx[j];
+    Idx[j] = t;
+  }
+
+  foo(A, Idx, B, n);
+
+  size_t hash = hashArray(B, n, 0);
+  delete [] A;
+  delete [] B;
+  delete [] Idx;
+
+  std::cerr << hash << "\n";
+
+  return 0;
+}
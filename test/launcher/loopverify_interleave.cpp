@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" int foo(int * A, int * B, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // below and between multiples of the interleaved width (2 * 8)
+  const int tripCounts[] = {5, 8, 16, 23, 16 * 100 + 9};
+
+  for (int n : tripCounts) {
+    int * A = new int[n];
+    for (int i = 0; i < n; ++i) {
+      A[i] = rand() % 1000;
+    }
+    int * B = new int[n]();
+
+    int s = foo(A, B, n);
+
+    size_t hash = hashArray(B, n, 0);
+    delete [] A;
+    delete [] B;
+
+    std::cerr << n << " " << s << " " << hash << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" void foo(float * A, float * B, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const int n = 8 * 100 + 5;
+
+  // room for up to four members per element
+  const int size = 4 * n;
+
+  float * A = new float[size];
+  float * B = new float[size];
+  for (int i = 0; i < size; ++i) {
+    A[i] = wfvRand();
+    B[i] = wfvRand();
+  }
+
+  foo(A, B, n);
+
+  // the gaps of the stores must keep their values
+  size_t hash = hashArray(B, size, 0);
+  delete [] A;
+  delete [] B;
+
+  std::cerr << hash << "\n";
+
+  return 0;
+}
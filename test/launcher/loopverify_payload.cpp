@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" int foo(int * A, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const int n = 8 * 100 + 5;
+
+  // few distinct values: the minimum and the maximum occur in several lanes
+  int * A = new int[n];
+  for (int i = 0; i < n; ++i) {
+    A[i] = rand() % 16;
+  }
+  int k = foo(A, n);
+
+  // all elements tie
+  int * C = new int[n];
+  for (int i = 0; i < n; ++i) {
+    C[i] = 13;
+  }
+  int kTie = foo(C, n);
+
+  delete [] A;
+  delete [] C;
+
+  std::cerr << k << " " << kTie << "\n";
+
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" void foo(float * A, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // below, at and between multiples of the vector width (8)
+  const int tripCounts[] = {1, 3, 7, 8, 13, 8 * 100, 8 * 100 + 5};
+
+  // stores of masked-out lanes would overwrite the guard elements
+  const int guard = 16;
+
+  for (int n : tripCounts) {
+    float * A = new float[n + guard];
+    for (int i = 0; i < n + guard; ++i) {
+      A[i] = wfvRand();
+    }
+
+    foo(A, n);
+
+    size_t hash = hashArray(A, n + guard, 0);
+    delete [] A;
+
+    std::cerr << n << " " << hash << "\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" int foo(float * A, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // below, at and between multiples of the vector width (8)
+  const int tripCounts[] = {1, 3, 7, 8, 13, 8 * 100, 8 * 100 + 5};
+
+  // masked-out lanes must not add the elements past the end
+  const int guard = 16;
+
+  for (int n : tripCounts) {
+    float * A = new float[n + guard];
+    for (int i = 0; i < n + guard; ++i) {
+      A[i] = wfvRand();
+    }
+
+    int s = foo(A, n);
+    delete [] A;
+
+    std::cerr << n << " " << s << "\n";
+  }
+
+  return 0;
+}
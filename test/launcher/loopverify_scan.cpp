@@ -0,0 +1,32 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" int foo(int * A, int * B, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const int n = 8 * 100 + 5;
+
+  int * A = new int[n];
+  for (int i = 0; i < n; ++i) {
+    A[i] = rand() % 1000;
+  }
+  int * B = new int[n]();
+
+  int s = foo(A, B, n);
+
+  // every prefix value is checked (not just the final one)
+  size_t hash = hashArray(B, n, 0);
+  delete [] A;
+  delete [] B;
+
+  std::cerr << s << " " << hash << "\n";
+
+  return 0;
+}
@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" void foo(float * A, float * B, int n);
+
+int main(int argc, char ** argv) {
+  srand(42);
+
+  // not a multiple of the vector width (remainder iterations)
+  const int n = 8 * 100 + 5;
+  const int size = 2 * n + 64;
+
+  // disjoint A and B run the vector loop.
+  // B = A + 1 (each iteration reads what the previous one wrote) and B = A - 1 fail the overlap check (scalar loop).
+  // the last two cases start on misaligned addresses (peel loop).
+  const int offsetsA[] = {0, 0, 1, 0, 3};
+  const int offsetsB[] = {n + 32, 1, 0, n + 37, n + 33};
+
+  for (int k = 0; k < 5; ++k) {
+    float * M = new float[size];
+    for (int i = 0; i < size; ++i) {
+      M[i] = wfvRand();
+    }
+
+    foo(M + offsetsA[k], M + offsetsB[k], n);
+
+    size_t hash = hashArray(M, size, 0);
+    delete [] M;
+
+    std::cerr << k << " " << hash << "\n";
+  }
+
+  return 0;
+}
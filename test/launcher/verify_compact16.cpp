@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" float16 foo_SIMD(float16 a, int16 b);
+
+int main(int argc, char ** argv) {
+  const uint vectorWidth = 16;
+  const uint numVectors = 200;
+
+  for (unsigned i = 0; i < numVectors; ++i) {
+    float a[16];
+    int b[16];
+    for (uint i = 0; i < vectorWidth; ++i) {
+      a[i] = (float) i;
+      b[i] = rand() % 5;
+    }
+
+    float16 res = foo_SIMD(*((float16*) &a), *((int16*) &b));
+
+    float exp[16];
+    for (uint i = 0, j = 0; i < vectorWidth; ++i) {
+      exp[i] = a[i];
+      if (b[i] != 0)
+        exp[j++] = a[i];
+    }
+    float resArray[16];
+    toArray16<float, float16>(res, resArray);
+    bool broken = false;
+    for (uint i = 0; i < vectorWidth; ++i) {
+      if (exp[i] != resArray[i]) {
+        std::cerr << "MISMATCH!\n";
+        broken = true;
+        break;
+      }
+    }
+    if (broken) {
+      std::cerr << "-- vectors --\n";
+      dumpArray(a, vectorWidth); std::cerr << "\n";
+      dumpArray(b, vectorWidth); std::cerr << "\n";
+
+      std::cerr << "-- result --\n";
+      dumpArray(resArray, vectorWidth);
+      std::cerr << "\n";
+
+      std::cerr << "-- expected --\n";
+      dumpArray(exp, vectorWidth);
+      return -1;
+    }
+  }
+
+  return 0;
+}
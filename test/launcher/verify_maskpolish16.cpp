@@ -0,0 +1,71 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <iostream>
+
+#include <cassert>
+
+#include "launcherTools.h"
+
+extern "C" int16 foo_SIMD(int16 a, int16 b);
+
+int main(int argc, char ** argv) {
+  const uint vectorWidth = 16;
+  const uint numVectors = 200;
+
+  for (unsigned v = 0; v < numVectors; ++v) {
+    // in every other vector, no lane has a > b
+    int a[16];
+    int b[16];
+    for (uint i = 0; i < vectorWidth; ++i) {
+      a[i] = rand() % 32 - 2;
+      b[i] = rand() % 32 + (v % 2) * 32;
+    }
+
+    int16 res = foo_SIMD(*((int16*) &a), *((int16*) &b));
+
+    bool anyGreater = false;
+    bool allPositive = true;
+    int ballot = 0;
+    for (uint i = 0; i < vectorWidth; ++i) {
+      anyGreater |= a[i] > b[i];
+      allPositive &= a[i] >= 0;
+      if (a[i] < b[i]) ballot |= 1 << i;
+    }
+
+    int exp[16];
+    for (uint i = 0; i < vectorWidth; ++i) {
+      int r = a[i] + (a[i] < b[i]);
+      r -= (a[i] > 2 * b[i]);
+      r += b[i] & -(int) (a[i] != b[i]);
+      if (anyGreater) r += 100;
+      if (allPositive) r += 1000;
+      exp[i] = r ^ ballot;
+    }
+
+    int resArray[16];
+    toArray16<int, int16>(res, resArray);
+    bool broken = false;
+    for (uint i = 0; i < vectorWidth; ++i) {
+      if (exp[i] != resArray[i]) {
+        std::cerr << "MISMATCH!\n";
+        broken = true;
+        break;
+      }
+    }
+    if (broken) {
+      std::cerr << "-- vectors --\n";
+      dumpArray(a, vectorWidth); std::cerr << "\n";
+      dumpArray(b, vectorWidth); std::cerr << "\n";
+
+      std::cerr << "-- result --\n";
+      dumpArray(resArray, vectorWidth);
+      std::cerr << "\n";
+
+      std::cerr << "-- expected --\n";
+      dumpArray(exp, vectorWidth);
+      return -1;
+    }
+  }
+
+  return 0;
+}
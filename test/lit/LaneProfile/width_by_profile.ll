@@ -0,0 +1,50 @@
+; RUN: env RV_REPORT=1 LV_DIAG=1 opt -enable-new-pm=0 -O3 -rv-loopvec -mattr=+avx2 %s -o /dev/null | FileCheck %s --check-prefix=STATIC
+; RUN: env RV_REPORT=1 LV_DIAG=1 RV_LANE_PROFILE_USE=%S/Inputs/width_by_profile.prof opt -enable-new-pm=0 -O3 -rv-loopvec -mattr=+avx2 %s -o /dev/null | FileCheck %s --check-prefix=PROFILE
+
+; Without a profile, the divisions make every vector width cheaper than the scalar loop.
+; STATIC: costModel: width 2 costs
+; STATIC-NOT: costModel: vectorization not beneficial
+
+; The profile says that only one in 64 scalar iterations executes %expensive (the vector loop blocks keep the names
+; of the scalar loop). Weighted by that occupancy, the scalar loop is cheaper than any vector width.
+; PROFILE: costModel: width 2 costs
+; PROFILE: costModel: vectorization not beneficial
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+define void @foo(double* noalias %A, i64 %n) {
+entry:
+  %hasIters = icmp sgt i64 %n, 0
+  br i1 %hasIters, label %loop, label %exit
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %latch ]
+  %ptr = getelementptr inbounds double, double* %A, i64 %i
+  %x = load double, double* %ptr, align 8
+  %isNeg = fcmp olt double %x, 0.000000e+00
+  br i1 %isNeg, label %expensive, label %latch
+
+expensive:
+  %d1 = fdiv double 1.000000e+00, %x
+  %d2 = fdiv double %d1, %x
+  %d3 = fdiv double %d2, %x
+  %d4 = fdiv double %d3, %x
+  %d5 = fdiv double %d4, %x
+  %d6 = fdiv double %d5, %x
+  %d7 = fdiv double %d6, %x
+  %d8 = fdiv double %d7, %x
+  store double %d8, double* %ptr, align 8
+  br label %latch
+
+latch:
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop, !llvm.loop !0
+
+exit:
+  ret void
+}
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.vectorize.enable", i1 true}
@@ -0,0 +1,10 @@
+// Shapes: T_TrT, Width: 16, LaunchCode: compact16
+//
+
+extern "C" float rv_compact(float, bool);
+
+extern "C" float
+foo(float a, int b)
+{
+    return rv_compact(a, b != 0);
+}
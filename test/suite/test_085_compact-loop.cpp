@@ -0,0 +1,12 @@
+// LoopHint: 0, LaunchCode: compact
+
+extern "C" int
+foo(float * A, float * B, int n) {
+  int k = 0;
+  for (int i = 0; i < n; ++i) {
+    if (((int) A[i] & 3) == 0) {
+      B[k++] = A[i];
+    }
+  }
+  return k;
+}
@@ -0,0 +1,13 @@
+// LoopHint: 0, LaunchCode: fooABCn
+
+extern "C" void
+foo(int * A, int * B, int * C, int n) {
+  for (int i = 0; i < n; ++i) {
+    int bin = A[i] & 15;
+    C[i] = __atomic_fetch_add(&B[bin], 1 + (C[i] & 3), __ATOMIC_SEQ_CST);
+    // B[16] counts the elements with bit 4 set (only some lanes take part)
+    if ((A[i] >> 4) & 1) {
+      __atomic_fetch_add(&B[16], 1, __ATOMIC_SEQ_CST);
+    }
+  }
+}
@@ -0,0 +1,9 @@
+// Pipeline: pass, LaunchCode: remainder
+
+extern "C" void
+foo(float * A, int n) {
+#pragma clang loop vectorize(assume_safety) vectorize_width(8) vectorize_predicate(enable)
+  for (int i = 0; i < n; ++i) {
+    A[i] = 2.0f * A[i] + 1.0f;
+  }
+}
@@ -0,0 +1,13 @@
+// Pipeline: pass, LoopMD[rv.loop.vectorize.remainder]: 1, LaunchCode: remainder
+
+extern "C" void
+foo(float * A, int n) {
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    if (A[i] > 0.0f) {
+      A[i] = 0.5f * A[i];
+    } else {
+      A[i] = -A[i];
+    }
+  }
+}
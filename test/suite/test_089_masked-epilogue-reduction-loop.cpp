@@ -0,0 +1,13 @@
+// Pipeline: pass, LoopMD[rv.loop.vectorize.remainder]: 1, LaunchCode: remainderred
+
+extern "C" int
+foo(float * A, int n) {
+  int s = 0;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    if (A[i] > 0.0f) {
+      s += (int) A[i];
+    }
+  }
+  return s;
+}
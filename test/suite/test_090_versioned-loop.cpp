@@ -0,0 +1,10 @@
+// Pipeline: pass, Env[RV_LOOP_VERSIONING]: 1, LaunchCode: versioning
+
+// vectorize(enable) instead of assume_safety: A and B are checked for overlap at runtime
+extern "C" void
+foo(float * A, float * B, int n) {
+#pragma clang loop vectorize(enable) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    B[i] = 2.0f * A[i] + 1.0f;
+  }
+}
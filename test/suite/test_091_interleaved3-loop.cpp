@@ -0,0 +1,16 @@
+// LoopHint: 0, Env[RV_INTERLEAVED]: 1, LaunchCode: interleaved
+
+struct Vec3 { float x, y, z; };
+
+extern "C" void
+foo(float * A, float * B, int n) {
+  Vec3 * In = (Vec3 *) A;
+  Vec3 * Out = (Vec3 *) B;
+  for (int i = 0; i < n; ++i) {
+    // z is never loaded (trailing gap), y is never stored (inner gap)
+    float x = In[i].x;
+    float y = In[i].y;
+    Out[i].x = x + y;
+    Out[i].z = x * y;
+  }
+}
@@ -0,0 +1,20 @@
+// LoopHint: 0, Env[RV_INTERLEAVED]: 1, LaunchCode: interleaved
+
+struct Vec4 { float x, y, z, w; };
+
+extern "C" void
+foo(float * A, float * B, int n) {
+  Vec4 * In = (Vec4 *) A;
+  Vec4 * Out = (Vec4 *) B;
+  for (int i = 0; i < n; ++i) {
+    // z is neither loaded nor stored (inner gap)
+    float x = In[i].x;
+    float y = In[i].y;
+    float w = In[i].w;
+    if (x > w) {
+      Out[i].x = x - w;
+      Out[i].y = y;
+      Out[i].w = w;
+    }
+  }
+}
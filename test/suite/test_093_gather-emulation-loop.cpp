@@ -0,0 +1,12 @@
+// LoopHint: 0, Env[RV_NO_GATHER]: 1, LaunchCode: gather
+
+extern "C" void
+foo(float * A, int * Idx, float * B, int n) {
+  for (int i = 0; i < n; ++i) {
+    // masked gather and scatter (emulated without the intrinsics)
+    if (A[i] > 0.0f) {
+      int k = Idx[i];
+      B[k] = A[k] + 1.0f;
+    }
+  }
+}
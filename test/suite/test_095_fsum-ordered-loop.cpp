@@ -0,0 +1,11 @@
+// Pipeline: pass, LoopMD[rv.loop.vectorize.reduction]: 3, LaunchCode: fsum
+
+extern "C" float
+foo(float * A, int n) {
+  float s = 0.0f;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    s += A[i];
+  }
+  return s;
+}
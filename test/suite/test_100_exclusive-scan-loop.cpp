@@ -0,0 +1,13 @@
+// Pipeline: pass, LaunchCode: scan
+
+extern "C" int
+foo(int * A, int * B, int n) {
+  int s = 0;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    int prefix = s;
+    s += A[i];
+    B[i] = prefix;
+  }
+  return s;
+}
@@ -0,0 +1,12 @@
+// Pipeline: pass, LaunchCode: scan
+
+extern "C" int
+foo(int * A, int * B, int n) {
+  int m = -1;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    m = A[i] > m ? A[i] : m;
+    B[i] = m;
+  }
+  return m;
+}
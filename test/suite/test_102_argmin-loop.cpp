@@ -0,0 +1,16 @@
+// Pipeline: pass, LaunchCode: payload
+
+extern "C" int
+foo(int * A, int n) {
+  int m = A[0];
+  int k = 0;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    // the first minimal element wins
+    if (A[i] < m) {
+      m = A[i];
+      k = i;
+    }
+  }
+  return k;
+}
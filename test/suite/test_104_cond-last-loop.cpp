@@ -0,0 +1,14 @@
+// Pipeline: pass, LaunchCode: payload
+
+extern "C" int
+foo(int * A, int n) {
+  int k = -1;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    // the last matching element wins
+    if (A[i] > 12) {
+      k = i;
+    }
+  }
+  return k;
+}
@@ -0,0 +1,13 @@
+// Pipeline: pass, LoopMD[rv.loop.interleave.count]: 2, LaunchCode: interleave
+
+// vectorized with 2 * 8 lanes, the sum is split into two accumulators
+extern "C" int
+foo(int * A, int * B, int n) {
+  int s = 0;
+#pragma clang loop vectorize(assume_safety) vectorize_width(8)
+  for (int i = 0; i < n; ++i) {
+    B[i] = 3 * A[i];
+    s += A[i];
+  }
+  return s;
+}
@@ -0,0 +1,19 @@
+// Shapes: T_TrT, Width: 16, Arch: avx512, Env[RV_ENABLE_POLISH]: 1, LaunchCode: maskpolish16
+
+extern "C" bool rv_any(bool);
+extern "C" bool rv_all(bool);
+extern "C" int rv_ballot(bool);
+
+extern "C" int
+foo(int a, int b)
+{
+  // masked increment, decrement and zero masking
+  int r = a + (a < b);
+  r -= (a > 2 * b);
+  r += b & -(int) (a != b);
+
+  // mask reductions and the mask bits
+  if (rv_any(a > b)) r += 100;
+  if (rv_all(a >= 0)) r += 1000;
+  return r ^ rv_ballot(a < b);
+}
@@ -23,6 +23,10 @@ Shapes: <ArgumentShapes>[r<ReturnValueShape] // WFV only
 Width: <vectorizationFactor>
 ULPMathPrec: <ULPError*10> // ULP error bound on math functions (in 10*ULP)
 VarShape[<GlobalVariable>]=<Shape> // Assign shape <Shape> to value <GlobalVariable>
+Env[<Variable>]: <Value> // Set the environment variable <Variable> when vectorizing
+Arch: avx512 // Build the test and its launcher for <Arch> (skipped if the host does not support it)
+Pipeline: pass // Loop only: vectorize the annotated loops with 'opt -rv-loopvec' instead of rvTool
+LoopMD[<Hint>]: <Value> // Pipeline: pass only: attach !{!"<Hint>", i32 <Value>} to every annotated loop
 """
   print(text)
 
@@ -45,6 +49,10 @@ class TestCase:
       return "build/" + primaryName + ".loopvec.ll"
     elif filetype == 'loopLogPrefix':
       return "logs/" + primaryName + ".loopvec"
+    elif filetype == 'rawLL':
+      return "build/" + primaryName + ".raw.ll"
+    elif filetype == 'hintedLL':
+      return "build/" + primaryName + ".hinted.ll"
 
   def __init__(self, testfile):
     self.srcFile = testfile
@@ -61,6 +69,11 @@ class TestCase:
     self.options['ulp_math_prec'] = 10
 
     self.options['extraShapes'] = dict()
+    self.options['env'] = dict()
+    self.options['loopMD'] = dict()
+    self.options['pipeline'] = "rvTool"
+    self.options['arch'] = None
+    self.options['archFlags'] = ""
 
     # default outer loop stencil
     self.options['width'] = 8 if self.mode == 'loop' else None
@@ -85,17 +98,26 @@ class TestCase:
         self.options['width'] = int(rhsPart)
       elif lhsPart == "ULPMathPrec":
         self.options['ulp_math_prec'] = int(rhsPart)
+      elif lhsPart == "Pipeline":
+        self.options['pipeline'] = rhsPart
+      elif lhsPart == "Arch":
+        self.options['arch'] = rhsPart
       else:
         namedMatch = re.search("\[(.*)\]", option)
         if not namedMatch is None:
           mStart = namedMatch.span()[0]
-          optName = option[:mStart]
+          optName = option[:mStart].strip()
           keyName = namedMatch.groups()[0]
-          self.options['extraShapes'][keyName] = rhsPart
+          if optName == "Env":
+            self.options['env'][keyName] = rhsPart
+          elif optName == "LoopMD":
+            self.options['loopMD'][keyName] = int(rhsPart)
+          else:
+            self.options['extraShapes'][keyName] = rhsPart
 
   def requestLauncher(self, prefix, profileMode):
     launcherCpp = "launcher/" + prefix + "_" + self.options['launchCode'] + ".cpp"
-    return (launcherCpp, "-Ilauncher/include")
+    return (launcherCpp, "-Ilauncher/include " + self.options['archFlags'])
 
 
 def runOuterLoopTester(scaLauncherBin, vecLauncherBin, profileMode):
@@ -132,6 +154,39 @@ def runWFVTester(launcherBin, profileMode):
   else:
     return success
 
+### loop annotations ###
+loopIDPattern = re.compile(r"^(!\d+) = distinct !\{\1(.*)\}$", re.MULTILINE)
+
+# attach the hints in @loopMD to every loop ID in @srcLL
+def annotateLoops(srcLL, destLL, loopMD):
+  with open(srcLL, 'r') as f:
+    text = f.read()
+  hintText = "".join(", !{{!\"{}\", i32 {}}}".format(k, v) for k, v in loopMD.items())
+  text = loopIDPattern.sub(lambda m: "{} = distinct !{{{}{}{}}}".format(m.group(1), m.group(1), m.group(2), hintText), text)
+  with open(destLL, 'w') as f:
+    f.write(text)
+
+# drop all loop annotations from @srcLL (scalar reference of Pipeline: pass tests)
+def stripLoopAnnotations(srcLL, destLL):
+  with open(srcLL, 'r') as f:
+    text = f.read()
+  text = re.sub(r", !llvm\.loop !\d+", "", text)
+  with open(destLL, 'w') as f:
+    f.write(text)
+
+### target architectures ###
+# clang flags and the (/proc/cpuinfo) host feature of each "Arch: <arch>"
+archFlagMap = {
+  "avx512": ("-mavx512f -mavx512vl -mavx512bw -mavx512dq", "avx512f"),
+}
+
+def hostSupports(cpuFeature):
+  try:
+    with open("/proc/cpuinfo", 'r') as f:
+      return cpuFeature in f.read().split()
+  except IOError:
+    return False
+
 ### test case failures ###
 rvToolReason="failed in rvTool"
 launcherReason="could not build launcher"
@@ -164,6 +219,16 @@ class Toolchain(object):
         return None
 
 
+def requestArchFlags(arch):
+  if arch is None:
+    return ""
+  if not arch in archFlagMap:
+    raise Unsupported("unknown arch {}".format(arch))
+  flags, cpuFeature = archFlagMap[arch]
+  if not hostSupports(cpuFeature):
+    raise Unsupported("host does not support {}".format(arch))
+  return flags
+
 # pure clang toolchain for the host target
 class HostClangToolchain(Toolchain):
     def __init__(self):
@@ -225,11 +290,54 @@ class HostClangToolchain(Toolchain):
 
       # create runner
       return lambda: runOuterLoopTester(scaLauncherBin, vecLauncherBin, profileMode)
+
+    # runs the RV loop vectorizer pass on the annotated loops (remainder, versioning, reduction and interleaving hints)
+    def buildPassLoopTester(self, testCase, profileMode):
+      prefix = "loopprofile" if profileMode else "loopverify"
+
+      rawLL = testCase.getFilename('rawLL')
+      if not self.clang.compileToRawIR(testCase.srcFile, rawLL, testCase.options['archFlags']):
+        raise TestFailure("compileToRawIR failed", None)
+
+      # the scalar reference must not be vectorized by LLVM (vectorize(enable) forces it)
+      scalarLL = testCase.getFilename('scalarLL')
+      stripLoopAnnotations(rawLL, scalarLL)
+
+      hintedLL = testCase.getFilename('hintedLL')
+      annotateLoops(rawLL, hintedLL, testCase.options['loopMD'])
+
+      vectorizedLL = testCase.getFilename('loopLL')
+      logPrefix = testCase.getFilename('loopLogPrefix') + ".opt"
+      ret = rvOptLoopVec(hintedLL, vectorizedLL, testCase.options, logPrefix)
+      if 0 != ret: raise TestFailure("opt -rv-loopvec failed", logPrefix)
+
+      launcherCpp, launcherCXXFlags = testCase.requestLauncher(prefix, profileMode)
+
+      caseName = primaryName(testCase.srcFile)
+
+      # build launcher binaries
+      vecLauncherBin = "./build/" + prefix + "_" + caseName + ".rv.bin"
+      ok = self.clang.compileCPP(vecLauncherBin, [vectorizedLL, launcherCpp], launcherCXXFlags)
+      if not ok:
+          raise TestFailure("compileCPP for vectorizedLL+launcher", None)
+
+      scaLauncherBin = "./build/" + prefix + "_" + caseName + ".scalar.bin"
+      ok = self.clang.compileCPP(scaLauncherBin, [scalarLL, launcherCpp], launcherCXXFlags)
+      if not ok:
+          raise TestFailure("compileCPP for scalarLL+launcher", None)
+
+      # create runner
+      return lambda: runOuterLoopTester(scaLauncherBin, vecLauncherBin, profileMode)
     
 
     def buildTestRunner(self, testCase, profileMode):
+      testCase.options['archFlags'] = requestArchFlags(testCase.options['arch'])
+
+      if test.mode == "loop" and testCase.options['pipeline'] == "pass":
+        return self.buildPassLoopTester(testCase, profileMode)
+
       scalarLL = testCase.getFilename('scalarLL')
-      self.clang.compileToIR(testCase.srcFile, scalarLL)
+      self.clang.compileToIR(testCase.srcFile, scalarLL, testCase.options['archFlags'])
 
       if test.mode == "wfv":
         return self.buildWFVTester(testCase, profileMode)